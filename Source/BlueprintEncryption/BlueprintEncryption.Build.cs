@@ -16,14 +16,19 @@ public class BlueprintEncryption : ModuleRules
 		bEnableUndefinedIdentifierWarnings = false;
 		bEnableExceptions = true;
 		bEnableObjCExceptions = true;
+		CppStandard = CppStandardVersion.Cpp17;
 		OptimizeCode = CodeOptimization.InShippingBuildsOnly;
+		// hash-library is compiled from source (Private/HashLibrary), its files reuse the same helper names
+		// in anonymous namespaces and can't share a unity translation unit
+		bUseUnity = false;
 
 		PublicIncludePaths.AddRange(
 			new string[]
 			{
 				Path.Combine(ThirdPartyPath),
 				Path.Combine(ThirdPartyPath, "jwt-cpp"),
-				Path.Combine(ThirdPartyPath, "hash-library")
+				Path.Combine(ThirdPartyPath, "hash-library"),
+				Path.Combine(ThirdPartyPath, "hash-library", "Public")
 			}
 		);
 		
@@ -38,7 +43,6 @@ public class BlueprintEncryption : ModuleRules
 			}
 		);
 		
-		PrivateDependencyModuleNames.AddRange(new string[] { "JsonUtilities" });
-		PublicAdditionalLibraries.Add(Path.Combine(ThirdPartyPath, "hash-library", "HashLibrary.lib"));
+		PrivateDependencyModuleNames.AddRange(new string[] { "Json", "JsonUtilities" });
 	}
 }
@@ -0,0 +1,89 @@
+// Copyright 2022 Chris Ringenberg https://www.ringenberg.dev/
+
+#include "AsyncHashAction.h"
+
+#include "BlueprintEncryptionLibrary.h"
+#include "HashAlgorithm.h"
+
+#include "Async/Async.h"
+
+namespace
+{
+	FString HashBytes(const EHashAlgorithm Algorithm, const void* Data, const size_t NumBytes)
+	{
+		const TUniquePtr<IHashAlgorithm> Hash = IHashAlgorithm::Create(Algorithm);
+		if (!Hash)
+		{
+			return {};
+		}
+
+		Hash->Add(Data, NumBytes);
+		return Hash->GetHash();
+	}
+}
+
+UAsyncHashAction* UAsyncHashAction::AsyncHash(UObject* WorldContextObject, const TArray<uint8>& BinaryData, const EHashAlgorithm Algorithm)
+{
+	return AsyncHash(WorldContextObject, TArray<uint8>(BinaryData), Algorithm);
+}
+
+UAsyncHashAction* UAsyncHashAction::AsyncHash(UObject* WorldContextObject, TArray<uint8>&& BinaryData, const EHashAlgorithm Algorithm)
+{
+	return Create(WorldContextObject, [BinaryData = MoveTemp(BinaryData), Algorithm]()
+	{
+		return HashBytes(Algorithm, BinaryData.GetData(), BinaryData.Num());
+	});
+}
+
+UAsyncHashAction* UAsyncHashAction::AsyncHashString(UObject* WorldContextObject, const FString& Data, const EHashAlgorithm Algorithm)
+{
+	return AsyncHashString(WorldContextObject, FString(Data), Algorithm);
+}
+
+UAsyncHashAction* UAsyncHashAction::AsyncHashString(UObject* WorldContextObject, FString&& Data, const EHashAlgorithm Algorithm)
+{
+	// the UTF-8 conversion of a large string is worth moving off the game thread, too
+	return Create(WorldContextObject, [Data = MoveTemp(Data), Algorithm]()
+	{
+		const FTCHARToUTF8 Utf8(*Data);
+		return HashBytes(Algorithm, Utf8.Get(), Utf8.Length());
+	});
+}
+
+UAsyncHashAction* UAsyncHashAction::AsyncSHA256(UObject* WorldContextObject, const TArray<uint8>& BinaryData)
+{
+	return AsyncHash(WorldContextObject, BinaryData, EHashAlgorithm::SHA256);
+}
+
+UAsyncHashAction* UAsyncHashAction::AsyncHashFile(UObject* WorldContextObject, const FString& FilePath, const EHashAlgorithm Algorithm)
+{
+	return Create(WorldContextObject, [FilePath, Algorithm]()
+	{
+		return UBlueprintEncryptionLibrary::HashFile(FilePath, Algorithm);
+	});
+}
+
+UAsyncHashAction* UAsyncHashAction::Create(UObject* WorldContextObject, TUniqueFunction<FString()>&& InWork)
+{
+	UAsyncHashAction* Action = NewObject<UAsyncHashAction>();
+	Action->Work = MoveTemp(InWork);
+	Action->RegisterWithGameInstance(WorldContextObject);
+	return Action;
+}
+
+void UAsyncHashAction::Activate()
+{
+	Async(EAsyncExecution::ThreadPool, [WeakThis = TWeakObjectPtr<UAsyncHashAction>(this), Work = MoveTemp(Work)]()
+	{
+		FString Digest = Work();
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Digest = MoveTemp(Digest)]()
+		{
+			if (UAsyncHashAction* Action = WeakThis.Get())
+			{
+				Action->OnCompleted.Broadcast(Digest);
+				Action->SetReadyToDestroy();
+			}
+		});
+	});
+}
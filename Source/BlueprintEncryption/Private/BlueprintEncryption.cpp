@@ -1,6 +1,7 @@
 // Copyright 2022 Chris Ringenberg https://www.ringenberg.dev/
 
 #include "BlueprintEncryption.h"
+#include "JwtKeyHandle.h"
 #include "Modules/ModuleManager.h"
 
 
@@ -12,6 +13,34 @@ void FBlueprintEncryptionModule::StartupModule()
 
 void FBlueprintEncryptionModule::ShutdownModule()
 {
+	FRWScopeLock Lock(KeysLock, SLT_Write);
+	Keys.Empty();
+}
+
+FBlueprintEncryptionModule& FBlueprintEncryptionModule::Get()
+{
+	return FModuleManager::LoadModuleChecked<FBlueprintEncryptionModule>("BlueprintEncryption");
+}
+
+void FBlueprintEncryptionModule::RegisterKey(UJwtKeyHandle* Key)
+{
+	check(Key);
+	FRWScopeLock Lock(KeysLock, SLT_Write);
+	Keys.Emplace(Key->GetKeyId(), TStrongObjectPtr<UJwtKeyHandle>(Key));
+}
+
+UJwtKeyHandle* FBlueprintEncryptionModule::FindKey(const FString& KeyId) const
+{
+	check(IsInGameThread());
+	FRWScopeLock Lock(KeysLock, SLT_ReadOnly);
+	const TStrongObjectPtr<UJwtKeyHandle>* Key = Keys.Find(KeyId);
+	return Key ? Key->Get() : nullptr;
+}
+
+void FBlueprintEncryptionModule::UnregisterKey(const FString& KeyId)
+{
+	FRWScopeLock Lock(KeysLock, SLT_Write);
+	Keys.Remove(KeyId);
 }
 
 #undef LOCTEXT_NAMESPACE
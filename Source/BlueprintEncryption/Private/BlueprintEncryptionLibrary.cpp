@@ -2,13 +2,138 @@
 
 #include "BlueprintEncryptionLibrary.h"
 
+#include "HashAlgorithm.h"
+#include "MappedFileReader.h"
+
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformFilemanager.h"
+
+#include "Public/blake3.h"
 #include "Public/crc32.h"
+#include "Public/crc32c.h"
 #include "Public/keccak.h"
 #include "Public/sha1.h"
 #include "Public/sha3.h"
 #include "Public/sha256.h"
+#include "Public/sha512.h"
 #include "Public/md5.h"
 
+#include <atomic>
+#include <vector>
+
+namespace
+{
+	// Every selected algorithm reads a chunk while it is still in L2, instead of each streaming the whole input from memory
+	constexpr int64 DigestChunkSize = 64 * 1024;
+
+	class FMultiHash
+	{
+	public:
+
+		explicit FMultiHash(const int32 AlgorithmMask)
+		{
+			for (int32 Bit = 0; Bit < 32; ++Bit)
+			{
+				if (AlgorithmMask & (1 << Bit))
+				{
+					const EHashAlgorithm Algorithm = static_cast<EHashAlgorithm>(Bit);
+					if (TUniquePtr<IHashAlgorithm> Hash = IHashAlgorithm::Create(Algorithm))
+					{
+						Hashes.Emplace(Algorithm, MoveTemp(Hash));
+					}
+				}
+			}
+		}
+
+		void Add(const uint8* Data, int64 NumBytes)
+		{
+			while (NumBytes > 0)
+			{
+				const int64 ChunkSize = FMath::Min(DigestChunkSize, NumBytes);
+				for (const TPair<EHashAlgorithm, TUniquePtr<IHashAlgorithm>>& Hash : Hashes)
+				{
+					Hash.Value->Add(Data, ChunkSize);
+				}
+
+				Data += ChunkSize;
+				NumBytes -= ChunkSize;
+			}
+		}
+
+		UE_NODISCARD FHashDigests GetDigests() const
+		{
+			FHashDigests Digests;
+			for (const TPair<EHashAlgorithm, TUniquePtr<IHashAlgorithm>>& Hash : Hashes)
+			{
+				Digests.Get(Hash.Key) = Hash.Value->GetHash();
+			}
+
+			return Digests;
+		}
+
+	private:
+
+		TArray<TPair<EHashAlgorithm, TUniquePtr<IHashAlgorithm>>> Hashes;
+	};
+
+	// The hash object lives on the stack, IHashAlgorithm is only needed where the algorithm is picked at runtime
+	template <typename HashType, typename... ArgTypes>
+	TArray<uint8> HashToBytes(const int32 DigestSize, const void* Data, const size_t NumBytes, ArgTypes... Args)
+	{
+		HashType Hash(Args...);
+		Hash.add(Data, NumBytes);
+
+		TArray<uint8> Digest;
+		Digest.SetNumUninitialized(DigestSize);
+		Hash.getHash(Digest.GetData());
+		return Digest;
+	}
+
+	template <typename HashType, typename... ArgTypes>
+	TArray<uint8> HashToBytes(const int32 DigestSize, const FString& Data, ArgTypes... Args)
+	{
+		const FTCHARToUTF8 Utf8(*Data);
+		return HashToBytes<HashType>(DigestSize, Utf8.Get(), static_cast<size_t>(Utf8.Length()), Args...);
+	}
+
+	// Smaller subtrees aren't worth the hand-off to other threads
+	constexpr int64 MinBlake3SubtreeSize = 64 * 1024;
+
+	// Hashes the complete subtrees of Data on all worker threads and adds the rest on the calling thread.
+	// Offset is the number of bytes added to Hash before, a subtree has to start at a multiple of its size
+	void AddBlake3Parallel(BLAKE3& Hash, const uint8* Data, const int64 NumBytes, const int64 Offset)
+	{
+		// a few subtrees per thread even out threads that get scheduled late
+		const int64 NumThreads = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+		int64 SubtreeSize = MinBlake3SubtreeSize;
+		while (SubtreeSize * 2 * 4 * NumThreads <= NumBytes && Offset % (SubtreeSize * 2) == 0)
+		{
+			SubtreeSize *= 2;
+		}
+
+		const int64 NumSubtrees = Offset % SubtreeSize == 0 ? NumBytes / SubtreeSize : 0;
+		if (NumSubtrees < 2)
+		{
+			Hash.add(Data, NumBytes);
+			return;
+		}
+
+		TArray<uint8> Halves;
+		Halves.SetNumUninitialized(NumSubtrees * 2 * BLAKE3::HashBytes);
+		ParallelFor(static_cast<int32>(NumSubtrees), [&](const int32 Index)
+		{
+			const int64 Begin = Index * SubtreeSize;
+			BLAKE3::hashSubtree(Data + Begin, SubtreeSize, (Offset + Begin) / BLAKE3::ChunkSize, &Halves[Index * 2 * BLAKE3::HashBytes]);
+		});
+
+		for (int64 Index = 0; Index < NumSubtrees; ++Index)
+		{
+			Hash.addSubtree(&Halves[Index * 2 * BLAKE3::HashBytes], SubtreeSize);
+		}
+		Hash.add(Data + NumSubtrees * SubtreeSize, NumBytes - NumSubtrees * SubtreeSize);
+	}
+}
+
 FString UBlueprintEncryptionLibrary::SHA256StringHash(const FString& Data)
 {
 	SHA256 SHA256;
@@ -22,6 +147,46 @@ FString UBlueprintEncryptionLibrary::SHA256BinaryHash(const TArray<uint8>& Binar
 	return SHA256(BinaryData.GetData(), BinaryData.Num()).c_str();
 }
 
+TArray<FString> UBlueprintEncryptionLibrary::SHA256BatchHash(const TArray<FString>& Data)
+{
+	return BatchHash(Data, SHA256::HashBytes, &SHA256::hashMany);
+}
+
+FString UBlueprintEncryptionLibrary::SHA512StringHash(const FString& Data)
+{
+	SHA512 SHA512;
+	return SHA512(ConvertFromFString(Data)).c_str();
+}
+
+FString UBlueprintEncryptionLibrary::SHA512BinaryHash(const TArray<uint8>& BinaryData)
+{
+	SHA512 SHA512;
+	return SHA512(BinaryData.GetData(), BinaryData.Num()).c_str();
+}
+
+FString UBlueprintEncryptionLibrary::SHA384StringHash(const FString& Data)
+{
+	SHA384 SHA384;
+	return SHA384(ConvertFromFString(Data)).c_str();
+}
+
+FString UBlueprintEncryptionLibrary::SHA384BinaryHash(const TArray<uint8>& BinaryData)
+{
+	SHA384 SHA384;
+	return SHA384(BinaryData.GetData(), BinaryData.Num()).c_str();
+}
+
+FString UBlueprintEncryptionLibrary::SHA512_256StringHash(const FString& Data)
+{
+	SHA512_256 SHA512_256;
+	return SHA512_256(ConvertFromFString(Data)).c_str();
+}
+
+FString UBlueprintEncryptionLibrary::SHA512_256BinaryHash(const TArray<uint8>& BinaryData)
+{
+	SHA512_256 SHA512_256;
+	return SHA512_256(BinaryData.GetData(), BinaryData.Num()).c_str();
+}
 
 FString UBlueprintEncryptionLibrary::SHA3StringHash(const FString& Data)
 {
@@ -35,6 +200,14 @@ FString UBlueprintEncryptionLibrary::SHA3BinaryHash(const TArray<uint8>& BinaryD
 	return SHA3(BinaryData.GetData(), BinaryData.Num()).c_str();
 }
 
+TArray<FString> UBlueprintEncryptionLibrary::SHA3BatchHash(const TArray<FString>& Data)
+{
+	return BatchHash(Data, SHA3::Bits256 / 8, [](size_t NumMessages, const void* const MessageData[], const size_t MessageSizes[], unsigned char Hashes[])
+	{
+		SHA3::hashMany(SHA3::Bits256, NumMessages, MessageData, MessageSizes, Hashes);
+	});
+}
+
 FString UBlueprintEncryptionLibrary::SHA1StringHash(const FString& Data)
 {
 	SHA1 SHA1;
@@ -59,6 +232,11 @@ FString UBlueprintEncryptionLibrary::MD5BinaryHash(const TArray<uint8>& BinaryDa
 	return MD5(BinaryData.GetData(), BinaryData.Num()).c_str();
 }
 
+TArray<FString> UBlueprintEncryptionLibrary::MD5BatchHash(const TArray<FString>& Data)
+{
+	return BatchHash(Data, MD5::HashBytes, &MD5::hashMany);
+}
+
 FString UBlueprintEncryptionLibrary::KeccakStringHash(const FString& Data)
 {
 	Keccak Keccak;
@@ -71,7 +249,322 @@ FString UBlueprintEncryptionLibrary::CRC32StringHash(const FString& Data)
 	return CRC32(ConvertFromFString(Data)).c_str();
 }
 
+FString UBlueprintEncryptionLibrary::CRC32BinaryHash(const TArray<uint8>& BinaryData)
+{
+	CRC32 CRC32;
+	return CRC32(BinaryData.GetData(), BinaryData.Num()).c_str();
+}
+
+FString UBlueprintEncryptionLibrary::ParallelCRC32File(const FString& FilePath)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	const int64 FileSize = PlatformFile.FileSize(*FilePath);
+	if (FileSize < 0)
+	{
+		return {};
+	}
+
+	// small files aren't worth the hand-off to other threads
+	constexpr int64 MinChunkSize = 16 * 1024 * 1024;
+	constexpr int64 ReadSize = 1024 * 1024;
+	const int32 MaxChunks = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+	const int32 NumChunks = static_cast<int32>(FMath::Clamp<int64>(FileSize / MinChunkSize, 1, MaxChunks));
+	const int64 ChunkSize = FMath::DivideAndRoundUp<int64>(FileSize, NumChunks);
+
+	TArray<uint32> ChunkHashes;
+	ChunkHashes.SetNumZeroed(NumChunks);
+	std::atomic<bool> bFailed{false};
+
+	ParallelFor(NumChunks, [&](const int32 ChunkIndex)
+	{
+		const int64 Begin = ChunkIndex * ChunkSize;
+		const int64 End = FMath::Min(Begin + ChunkSize, FileSize);
+
+		// every chunk reads through its own handle, so the threads don't have to share a file position
+		const TUniquePtr<IFileHandle> FileHandle(PlatformFile.OpenRead(*FilePath));
+		if (!FileHandle || !FileHandle->Seek(Begin))
+		{
+			bFailed = true;
+			return;
+		}
+
+		TArray<uint8> Buffer;
+		Buffer.SetNumUninitialized(FMath::Min(ReadSize, End - Begin));
+
+		CRC32 CRC32;
+		for (int64 Offset = Begin; Offset < End && !bFailed;)
+		{
+			const int64 NumBytes = FMath::Min<int64>(Buffer.Num(), End - Offset);
+			if (!FileHandle->Read(Buffer.GetData(), NumBytes))
+			{
+				bFailed = true;
+				return;
+			}
+
+			CRC32.add(Buffer.GetData(), NumBytes);
+			Offset += NumBytes;
+		}
+
+		uint8 Digest[CRC32::HashBytes];
+		CRC32.getHash(Digest);
+		ChunkHashes[ChunkIndex] = (Digest[0] << 24) | (Digest[1] << 16) | (Digest[2] << 8) | Digest[3];
+	});
+
+	if (bFailed)
+	{
+		return {};
+	}
+
+	uint32 Hash = ChunkHashes[0];
+	for (int32 ChunkIndex = 1; ChunkIndex < NumChunks; ++ChunkIndex)
+	{
+		const int64 Begin = ChunkIndex * ChunkSize;
+		const int64 End = FMath::Min(Begin + ChunkSize, FileSize);
+		Hash = CRC32::combine(Hash, ChunkHashes[ChunkIndex], End - Begin);
+	}
+
+	return FString::Printf(TEXT("%08x"), Hash);
+}
+
+FString UBlueprintEncryptionLibrary::CRC32CStringHash(const FString& Data)
+{
+	CRC32C CRC32C;
+	return CRC32C(ConvertFromFString(Data)).c_str();
+}
+
+FString UBlueprintEncryptionLibrary::CRC32CBinaryHash(const TArray<uint8>& BinaryData)
+{
+	CRC32C CRC32C;
+	return CRC32C(BinaryData.GetData(), BinaryData.Num()).c_str();
+}
+
+FString UBlueprintEncryptionLibrary::BLAKE3StringHash(const FString& Data)
+{
+	BLAKE3 BLAKE3;
+	return BLAKE3(ConvertFromFString(Data)).c_str();
+}
+
+FString UBlueprintEncryptionLibrary::BLAKE3BinaryHash(const TArray<uint8>& BinaryData)
+{
+	BLAKE3 BLAKE3;
+	AddBlake3Parallel(BLAKE3, BinaryData.GetData(), BinaryData.Num(), 0);
+	return BLAKE3.getHash().c_str();
+}
+
+FString UBlueprintEncryptionLibrary::ParallelBLAKE3File(const FString& FilePath)
+{
+	BLAKE3 BLAKE3;
+	int64 Offset = 0;
+	const bool bRead = FMappedFileReader::Read(FilePath, [&BLAKE3, &Offset](const uint8* Data, const int64 NumBytes)
+	{
+		AddBlake3Parallel(BLAKE3, Data, NumBytes, Offset);
+		Offset += NumBytes;
+	});
+
+	return bRead ? FString(BLAKE3.getHash().c_str()) : FString();
+}
+
+TArray<uint8> UBlueprintEncryptionLibrary::SHA256StringHashBytes(const FString& Data)
+{
+	return HashToBytes<SHA256>(SHA256::HashBytes, Data);
+}
+
+TArray<uint8> UBlueprintEncryptionLibrary::SHA256BinaryHashBytes(const TArray<uint8>& BinaryData)
+{
+	return HashToBytes<SHA256>(SHA256::HashBytes, BinaryData.GetData(), BinaryData.Num());
+}
+
+TArray<uint8> UBlueprintEncryptionLibrary::SHA512StringHashBytes(const FString& Data)
+{
+	return HashToBytes<SHA512>(SHA512::HashBytes, Data);
+}
+
+TArray<uint8> UBlueprintEncryptionLibrary::SHA512BinaryHashBytes(const TArray<uint8>& BinaryData)
+{
+	return HashToBytes<SHA512>(SHA512::HashBytes, BinaryData.GetData(), BinaryData.Num());
+}
+
+TArray<uint8> UBlueprintEncryptionLibrary::SHA384StringHashBytes(const FString& Data)
+{
+	return HashToBytes<SHA384>(SHA384::HashBytes, Data);
+}
+
+TArray<uint8> UBlueprintEncryptionLibrary::SHA384BinaryHashBytes(const TArray<uint8>& BinaryData)
+{
+	return HashToBytes<SHA384>(SHA384::HashBytes, BinaryData.GetData(), BinaryData.Num());
+}
+
+TArray<uint8> UBlueprintEncryptionLibrary::SHA512_256StringHashBytes(const FString& Data)
+{
+	return HashToBytes<SHA512_256>(SHA512_256::HashBytes, Data);
+}
+
+TArray<uint8> UBlueprintEncryptionLibrary::SHA512_256BinaryHashBytes(const TArray<uint8>& BinaryData)
+{
+	return HashToBytes<SHA512_256>(SHA512_256::HashBytes, BinaryData.GetData(), BinaryData.Num());
+}
+
+TArray<uint8> UBlueprintEncryptionLibrary::SHA3StringHashBytes(const FString& Data)
+{
+	return HashToBytes<SHA3>(SHA3::Bits256 / 8, Data, SHA3::Bits256);
+}
+
+TArray<uint8> UBlueprintEncryptionLibrary::SHA3BinaryHashBytes(const TArray<uint8>& BinaryData)
+{
+	return HashToBytes<SHA3>(SHA3::Bits256 / 8, BinaryData.GetData(), BinaryData.Num(), SHA3::Bits256);
+}
+
+TArray<uint8> UBlueprintEncryptionLibrary::SHA1StringHashBytes(const FString& Data)
+{
+	return HashToBytes<SHA1>(SHA1::HashBytes, Data);
+}
+
+TArray<uint8> UBlueprintEncryptionLibrary::SHA1BinaryHashBytes(const TArray<uint8>& BinaryData)
+{
+	return HashToBytes<SHA1>(SHA1::HashBytes, BinaryData.GetData(), BinaryData.Num());
+}
+
+TArray<uint8> UBlueprintEncryptionLibrary::MD5StringHashBytes(const FString& Data)
+{
+	return HashToBytes<MD5>(MD5::HashBytes, Data);
+}
+
+TArray<uint8> UBlueprintEncryptionLibrary::MD5BinaryHashBytes(const TArray<uint8>& BinaryData)
+{
+	return HashToBytes<MD5>(MD5::HashBytes, BinaryData.GetData(), BinaryData.Num());
+}
+
+TArray<uint8> UBlueprintEncryptionLibrary::KeccakStringHashBytes(const FString& Data)
+{
+	return HashToBytes<Keccak>(Keccak::Keccak256 / 8, Data, Keccak::Keccak256);
+}
+
+TArray<uint8> UBlueprintEncryptionLibrary::KeccakBinaryHashBytes(const TArray<uint8>& BinaryData)
+{
+	return HashToBytes<Keccak>(Keccak::Keccak256 / 8, BinaryData.GetData(), BinaryData.Num(), Keccak::Keccak256);
+}
+
+TArray<uint8> UBlueprintEncryptionLibrary::CRC32StringHashBytes(const FString& Data)
+{
+	return HashToBytes<CRC32>(CRC32::HashBytes, Data);
+}
+
+TArray<uint8> UBlueprintEncryptionLibrary::CRC32BinaryHashBytes(const TArray<uint8>& BinaryData)
+{
+	return HashToBytes<CRC32>(CRC32::HashBytes, BinaryData.GetData(), BinaryData.Num());
+}
+
+TArray<uint8> UBlueprintEncryptionLibrary::CRC32CStringHashBytes(const FString& Data)
+{
+	return HashToBytes<CRC32C>(CRC32C::HashBytes, Data);
+}
+
+TArray<uint8> UBlueprintEncryptionLibrary::CRC32CBinaryHashBytes(const TArray<uint8>& BinaryData)
+{
+	return HashToBytes<CRC32C>(CRC32C::HashBytes, BinaryData.GetData(), BinaryData.Num());
+}
+
+TArray<uint8> UBlueprintEncryptionLibrary::BLAKE3StringHashBytes(const FString& Data)
+{
+	return HashToBytes<BLAKE3>(BLAKE3::HashBytes, Data);
+}
+
+TArray<uint8> UBlueprintEncryptionLibrary::BLAKE3BinaryHashBytes(const TArray<uint8>& BinaryData)
+{
+	BLAKE3 BLAKE3;
+	AddBlake3Parallel(BLAKE3, BinaryData.GetData(), BinaryData.Num(), 0);
+
+	TArray<uint8> Digest;
+	Digest.SetNumUninitialized(BLAKE3::HashBytes);
+	BLAKE3.getHash(Digest.GetData());
+	return Digest;
+}
+
+FString UBlueprintEncryptionLibrary::HashFile(const FString& FilePath, const EHashAlgorithm Algorithm)
+{
+	const TUniquePtr<IHashAlgorithm> Hash = IHashAlgorithm::Create(Algorithm);
+	if (!Hash)
+	{
+		return {};
+	}
+
+	const bool bRead = FMappedFileReader::Read(FilePath, [&Hash](const uint8* Data, const int64 NumBytes)
+	{
+		Hash->Add(Data, NumBytes);
+	});
+
+	return bRead ? Hash->GetHash() : FString();
+}
+
+FHashDigests UBlueprintEncryptionLibrary::ComputeDigests(const TArray<uint8>& BinaryData, const int32 AlgorithmMask)
+{
+	FMultiHash MultiHash(AlgorithmMask);
+	MultiHash.Add(BinaryData.GetData(), BinaryData.Num());
+	return MultiHash.GetDigests();
+}
+
+FHashDigests UBlueprintEncryptionLibrary::ComputeFileDigests(const FString& FilePath, const int32 AlgorithmMask)
+{
+	FMultiHash MultiHash(AlgorithmMask);
+	const bool bRead = FMappedFileReader::Read(FilePath, [&MultiHash](const uint8* Data, const int64 NumBytes)
+	{
+		MultiHash.Add(Data, NumBytes);
+	});
+
+	return bRead ? MultiHash.GetDigests() : FHashDigests();
+}
+
 std::string UBlueprintEncryptionLibrary::ConvertFromFString(const FString& InS)
 {
 	return TCHAR_TO_UTF8(*InS);
 }
+
+TArray<FString> UBlueprintEncryptionLibrary::BatchHash(const TArray<FString>& Data, const int32 HashBytes,
+                                                       TFunctionRef<void(size_t, const void* const[], const size_t[], unsigned char[])> HashMany)
+{
+	// std::string is not bitwise relocatable, so it can't live in a TArray
+	std::vector<std::string> Messages;
+	Messages.reserve(Data.Num());
+	for (const FString& Item : Data)
+	{
+		Messages.push_back(ConvertFromFString(Item));
+	}
+
+	TArray<const void*> MessageData;
+	TArray<size_t> MessageSizes;
+	MessageData.Reserve(Data.Num());
+	MessageSizes.Reserve(Data.Num());
+	for (const std::string& Message : Messages)
+	{
+		MessageData.Add(Message.data());
+		MessageSizes.Add(Message.size());
+	}
+
+	TArray<uint8> Digests;
+	Digests.SetNumUninitialized(Data.Num() * HashBytes);
+	HashMany(Data.Num(), MessageData.GetData(), MessageSizes.GetData(), Digests.GetData());
+
+	TArray<FString> OutHashes;
+	OutHashes.Reserve(Data.Num());
+	for (int32 Index = 0; Index < Data.Num(); ++Index)
+	{
+		OutHashes.Add(ConvertDigestToString(Digests.GetData() + Index * HashBytes, HashBytes));
+	}
+
+	return OutHashes;
+}
+
+FString UBlueprintEncryptionLibrary::ConvertDigestToString(const uint8* Digest, const int32 NumBytes)
+{
+	static const TCHAR Dec2Hex[] = TEXT("0123456789abcdef");
+
+	FString OutString;
+	OutString.Reserve(NumBytes * 2);
+	for (int32 Index = 0; Index < NumBytes; ++Index)
+	{
+		OutString.AppendChar(Dec2Hex[Digest[Index] >> 4]);
+		OutString.AppendChar(Dec2Hex[Digest[Index] & 15]);
+	}
+
+	return OutString;
+}
@@ -2,3 +2,21 @@
 
 #include "BlueprintEncryptionTypes.h"
 
+FString& FHashDigests::Get(const EHashAlgorithm Algorithm)
+{
+	switch (Algorithm)
+	{
+		case EHashAlgorithm::SHA256: return SHA256;
+		case EHashAlgorithm::SHA1: return SHA1;
+		case EHashAlgorithm::MD5: return MD5;
+		case EHashAlgorithm::SHA3: return SHA3;
+		case EHashAlgorithm::Keccak: return Keccak;
+		case EHashAlgorithm::CRC32: return CRC32;
+		case EHashAlgorithm::CRC32C: return CRC32C;
+		case EHashAlgorithm::SHA512: return SHA512;
+		case EHashAlgorithm::SHA384: return SHA384;
+		case EHashAlgorithm::SHA512_256: return SHA512_256;
+		case EHashAlgorithm::BLAKE3: return BLAKE3;
+		default: checkNoEntry(); return SHA256;
+	}
+}
@@ -2,12 +2,20 @@
 
 #include "BlueprintJWTLibrary.h"
 
+#include "BlueprintEncryption.h"
+#include "JwtTokenWriter.h"
+#include "StructClaimWriter.h"
+
+#include "Async/ParallelFor.h"
+
 #include "JsonObjectConverter.h"
 
 #include "Kismet/KismetMathLibrary.h"
 
 #include "ThirdParty/jwt-cpp/jwt.h"
 
+#include <cmath>
+
 FString UBlueprintJwtLibrary::K2_EncodeToken_RS(FString Audience, FString Issuer, FString Subject,
                                                 FString PayloadClaimType, FString PayloadClaim, FString PublicKey,
                                                 FString PublicKeyPassword,
@@ -44,6 +52,198 @@ FString UBlueprintJwtLibrary::K2_EncodeToken_HS(FString Audience, FString Issuer
 
 }
 
+URSAKeyHandle* UBlueprintJwtLibrary::RegisterRSAKey(const FString& KeyId, FString PublicKey, FString PublicKeyPassword,
+                                                    FString PrivateKey, FString PrivateKeyPassword, ERSAlgorithm Algorithm)
+{
+	URSAKeyHandle* Key = URSAKeyHandle::Create(KeyId, ConvertFromFString(PublicKey), ConvertFromFString(PrivateKey),
+	                                           ConvertFromFString(PublicKeyPassword), ConvertFromFString(PrivateKeyPassword),
+	                                           Algorithm);
+	if (!Key->IsValidKey())
+	{
+		return nullptr;
+	}
+
+	FBlueprintEncryptionModule::Get().RegisterKey(Key);
+	return Key;
+}
+
+UHMACKeyHandle* UBlueprintJwtLibrary::RegisterHMACKey(const FString& KeyId, FString Secret, EHSAlgorithm Algorithm)
+{
+	UHMACKeyHandle* Key = UHMACKeyHandle::Create(KeyId, ConvertFromFString(Secret), Algorithm);
+	if (!Key->IsValidKey())
+	{
+		return nullptr;
+	}
+
+	FBlueprintEncryptionModule::Get().RegisterKey(Key);
+	return Key;
+}
+
+UJwtKeyHandle* UBlueprintJwtLibrary::FindKey(const FString& KeyId)
+{
+	return FBlueprintEncryptionModule::Get().FindKey(KeyId);
+}
+
+void UBlueprintJwtLibrary::UnregisterKey(const FString& KeyId)
+{
+	FBlueprintEncryptionModule::Get().UnregisterKey(KeyId);
+}
+
+FString UBlueprintJwtLibrary::K2_EncodeToken_Key(FString Audience, FString Issuer, FString Subject,
+                                                 FString PayloadClaimType, FString PayloadClaim, UJwtKeyHandle* Key,
+                                                 int32 ExpiresAt)
+{
+	if (!Key || !Key->IsValidKey())
+	{
+		return TEXT("ERROR");
+	}
+
+	const auto Now = std::chrono::system_clock::now();
+
+	const auto Token = jwt::create()
+	                   .set_type(ConvertFromFString(TEXT("JWT")))
+	                   .set_audience(ConvertFromFString(Audience))
+	                   .set_issued_at(Now)
+	                   .set_expires_at(Now + std::chrono::seconds{ExpiresAt})
+	                   .set_issuer(ConvertFromFString(Issuer))
+	                   .set_subject(ConvertFromFString(Subject))
+	                   .set_payload_claim(ConvertFromFString(PayloadClaimType),
+	                                      jwt::claim(std::string(ConvertFromFString(PayloadClaim))))
+	                   .sign(FJwtKeyHandleAlgorithm{*Key});
+
+	return Token.c_str();
+}
+
+TArray<FString> UBlueprintJwtLibrary::EncodeTokensBatch(const TArray<FJwtClaimsSet>& Claims, UJwtKeyHandle* Key)
+{
+	TArray<FString> OutTokens;
+	if (!Key || !Key->IsValidKey())
+	{
+		OutTokens.Init(TEXT("ERROR"), Claims.Num());
+		return OutTokens;
+	}
+
+	OutTokens.SetNum(Claims.Num());
+
+	// all tokens share the same header and iat claim
+	const int64_t Now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+
+	const auto EncodeRange = [&](const int32 Begin, const int32 End)
+	{
+		// reused for every token of this range, so its buffers only allocate until they've grown large enough
+		FJwtTokenWriter TokenWriter;
+		TokenWriter.Reset(*Key, Now);
+
+		for (int32 Index = Begin; Index < End; ++Index)
+		{
+			const FJwtClaimsSet& Set = Claims[Index];
+
+			// a payload claim replaces the registered claim of the same name
+			const auto IsOverridden = [&Set](const TCHAR* Name)
+			{
+				for (const TPair<FString, FString>& Claim : Set.PayloadClaims)
+				{
+					if (Claim.Key.Equals(Name, ESearchCase::CaseSensitive))
+					{
+						return true;
+					}
+				}
+				return false;
+			};
+
+			TokenWriter.BeginPayload(Set.ExpiresAt, !IsOverridden(TEXT("iat")), !IsOverridden(TEXT("exp")));
+			if (!IsOverridden(TEXT("aud")))
+			{
+				TokenWriter.WriteClaim(TEXT("aud"), Set.Audience);
+			}
+			if (!IsOverridden(TEXT("iss")))
+			{
+				TokenWriter.WriteClaim(TEXT("iss"), Set.Issuer);
+			}
+			if (!IsOverridden(TEXT("sub")))
+			{
+				TokenWriter.WriteClaim(TEXT("sub"), Set.Subject);
+			}
+			for (const TPair<FString, FString>& Claim : Set.PayloadClaims)
+			{
+				TokenWriter.WriteClaim(*Claim.Key, Claim.Value);
+			}
+
+			OutTokens[Index] = TokenWriter.Finish();
+		}
+	};
+
+	const int32 NumTasks = Key->IsAsymmetric()
+		                       ? FMath::Min(Claims.Num(), FTaskGraphInterface::Get().GetNumWorkerThreads() + 1)
+		                       : 1;
+	if (NumTasks > 1)
+	{
+		ParallelFor(NumTasks, [&](const int32 Task)
+		{
+			EncodeRange(Claims.Num() * Task / NumTasks, Claims.Num() * (Task + 1) / NumTasks);
+		});
+	}
+	else
+	{
+		EncodeRange(0, Claims.Num());
+	}
+
+	return OutTokens;
+}
+
+DEFINE_FUNCTION(UBlueprintJwtLibrary::execEncodeStructAsToken)
+{
+	Stack.StepCompiledIn<FProperty>(nullptr);
+	FProperty* ValueProperty = Stack.MostRecentProperty;
+	void* ValuePtr = Stack.MostRecentPropertyAddress;
+
+	P_GET_OBJECT(UJwtKeyHandle, Key);
+	P_GET_PROPERTY(FIntProperty, ExpiresAt);
+
+	P_FINISH;
+
+	if (!ValueProperty || !ValuePtr)
+	{
+		const FBlueprintExceptionInfo ExceptionInfo(
+			EBlueprintExceptionType::AccessViolation,
+			NSLOCTEXT("BlueprintJWT", "EncodeStructAsToken_MissingInputProperty", "Failed to resolve the input parameter for EncodeStructAsToken.")
+		);
+		FBlueprintCoreDelegates::ThrowScriptException(P_THIS, Stack, ExceptionInfo);
+		*StaticCast<FString*>(RESULT_PARAM) = TEXT("ERROR");
+		return;
+	}
+
+	FStructProperty* const StructProperty = CastField<FStructProperty>(ValueProperty);
+	if (!StructProperty)
+	{
+		*StaticCast<FString*>(RESULT_PARAM) = TEXT("ERROR");
+		return;
+	}
+
+	P_NATIVE_BEGIN
+	*StaticCast<FString*>(RESULT_PARAM) = EncodeStructDataAsToken(StructProperty->Struct, ValuePtr, Key, ExpiresAt);
+	P_NATIVE_END
+}
+
+FString UBlueprintJwtLibrary::EncodeStructDataAsToken(const UScriptStruct* Struct, const void* StructData, const UJwtKeyHandle* Key,
+                                                      const int32 ExpiresAt)
+{
+	if (!Struct || !StructData || !Key || !Key->IsValidKey())
+	{
+		return TEXT("ERROR");
+	}
+
+	const TSharedRef<const FStructClaimWriter, ESPMode::ThreadSafe> Writer = FStructClaimWriter::Get(Struct);
+
+	// reused by every token encoded on this thread
+	thread_local FJwtTokenWriter TokenWriter;
+	TokenWriter.Reset(*Key, std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()));
+
+	std::string& Json = TokenWriter.BeginPayload(ExpiresAt, !Writer->HasClaim(TEXT("iat")), !Writer->HasClaim(TEXT("exp")));
+	Writer->Write(StructData, Json);
+	return TokenWriter.Finish();
+}
+
 TMap<FString, FString> UBlueprintJwtLibrary::K2_DecodeToken(const FString& JWT)
 {
 	if (JWT.IsEmpty())
@@ -51,18 +251,122 @@ TMap<FString, FString> UBlueprintJwtLibrary::K2_DecodeToken(const FString& JWT)
 		return {};
 	}
 
-	const auto DecodedJWT = jwt::decode(ConvertFromFString(JWT));
+	// the view decodes into a buffer that is reused by every call on this thread, instead of copying the token 7 times
+	thread_local jwt::decoded_jwt_view DecodedJWT;
+	const FTCHARToUTF8 Utf8(*JWT);
+	if (!DecodedJWT.parse(std::string_view(Utf8.Get(), Utf8.Length())))
+	{
+		return {};
+	}
+
+	thread_local jwt::claims_document Claims;
+	if (!Claims.parse(DecodedJWT.get_payload()))
+	{
+		return {};
+	}
+
 	TMap<FString, FString> OutMap;
-	OutMap.Reserve(DecodedJWT.get_payload_claims().size());
-	
-	for (const auto& Item : DecodedJWT.get_payload_claims())
+	OutMap.Reserve(Claims.size());
+
+	Claims.for_each_json([&OutMap](const std::string_view Name, const std::string& Json)
 	{
-		OutMap.Add(Item.first.c_str(), Item.second.to_json().serialize().c_str());
+		const FUTF8ToTCHAR Key(Name.data(), Name.size());
+		OutMap.Add(FString(Key.Length(), Key.Get()), UTF8_TO_TCHAR(Json.c_str()));
+	});
+
+	return OutMap;
+}
+
+TMap<FString, FJwtClaimValue> UBlueprintJwtLibrary::K2_DecodeTokenTyped(const FString& JWT)
+{
+	if (JWT.IsEmpty())
+	{
+		return {};
 	}
 
+	thread_local jwt::decoded_jwt_view DecodedJWT;
+	const FTCHARToUTF8 Utf8(*JWT);
+	if (!DecodedJWT.parse(std::string_view(Utf8.Get(), Utf8.Length())))
+	{
+		return {};
+	}
+
+	thread_local jwt::claims_document Claims;
+	if (!Claims.parse(DecodedJWT.get_payload()))
+	{
+		return {};
+	}
+
+	TMap<FString, FJwtClaimValue> OutMap;
+	ReadClaims(Claims, OutMap);
 	return OutMap;
 }
 
+void UBlueprintJwtLibrary::ReadClaims(const jwt::claims_document& Payload, TMap<FString, FJwtClaimValue>& OutClaims)
+{
+	const auto ToFString = [](const std::string_view Utf8)
+	{
+		const FUTF8ToTCHAR Converted(Utf8.data(), Utf8.size());
+		return FString(Converted.Length(), Converted.Get());
+	};
+
+	// only non string values are serialized, always into the same buffer
+	std::string Json;
+	const auto ToJson = [&Json, &ToFString](const jwt::claims_document::value_view& Value)
+	{
+		Json.clear();
+		Value.serialize(Json);
+		return ToFString(Json);
+	};
+
+	OutClaims.Reserve(OutClaims.Num() + Payload.size());
+	Payload.for_each_claim([&](const std::string_view Name, const jwt::claims_document::value_view& Value)
+	{
+		FJwtClaimValue& Claim = OutClaims.Add(ToFString(Name));
+		switch (Value.get_type())
+		{
+			case jwt::claim::type::string:
+				Claim.Type = EJwtClaimType::String;
+				Claim.String = ToFString(Value.as_string());
+				break;
+			case jwt::claim::type::int64:
+				Claim.Type = EJwtClaimType::Integer;
+				Claim.Integer = Value.as_int();
+				break;
+			case jwt::claim::type::number:
+			{
+				Claim.Type = EJwtClaimType::Number;
+				const double Number = Value.as_number();
+				// the cast is undefined for NaN and out of range values, those are only available as String
+				if (Number >= -9223372036854775808.0 && Number < 9223372036854775808.0 && std::trunc(Number) == Number)
+				{
+					Claim.Integer = static_cast<int64>(Number);
+				}
+				Claim.String = ToJson(Value);
+				break;
+			}
+			case jwt::claim::type::boolean:
+				Claim.Type = EJwtClaimType::Boolean;
+				Claim.Boolean = Value.as_bool();
+				break;
+			case jwt::claim::type::array:
+				Claim.Type = EJwtClaimType::Array;
+				Claim.Array.Reserve(Value.size());
+				Value.for_each_element([&](const jwt::claims_document::value_view& Element)
+				{
+					Claim.Array.Add(Element.get_type() == jwt::claim::type::string ? ToFString(Element.as_string()) : ToJson(Element));
+				});
+				break;
+			case jwt::claim::type::object:
+				Claim.Type = EJwtClaimType::Object;
+				Claim.String = ToJson(Value);
+				break;
+			default:
+				break;
+		}
+	});
+}
+
 DEFINE_FUNCTION(UBlueprintJwtLibrary::execSerializeStructToString)
 {
 	Stack.StepCompiledIn<FProperty>(nullptr);
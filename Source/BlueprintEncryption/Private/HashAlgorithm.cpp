@@ -0,0 +1,32 @@
+// Copyright 2022 Chris Ringenberg https://www.ringenberg.dev/
+
+#include "HashAlgorithm.h"
+
+#include "Public/blake3.h"
+#include "Public/crc32.h"
+#include "Public/crc32c.h"
+#include "Public/keccak.h"
+#include "Public/sha1.h"
+#include "Public/sha3.h"
+#include "Public/sha256.h"
+#include "Public/sha512.h"
+#include "Public/md5.h"
+
+TUniquePtr<IHashAlgorithm> IHashAlgorithm::Create(const EHashAlgorithm Algorithm)
+{
+	switch (Algorithm)
+	{
+		case EHashAlgorithm::SHA256: return MakeUnique<THashAlgorithm<SHA256>>(SHA256::HashBytes);
+		case EHashAlgorithm::SHA1: return MakeUnique<THashAlgorithm<SHA1>>(SHA1::HashBytes);
+		case EHashAlgorithm::MD5: return MakeUnique<THashAlgorithm<MD5>>(MD5::HashBytes);
+		case EHashAlgorithm::SHA3: return MakeUnique<THashAlgorithm<SHA3>>(SHA3::Bits256 / 8, SHA3::Bits256);
+		case EHashAlgorithm::Keccak: return MakeUnique<THashAlgorithm<Keccak>>(Keccak::Keccak256 / 8, Keccak::Keccak256);
+		case EHashAlgorithm::CRC32: return MakeUnique<THashAlgorithm<CRC32>>(CRC32::HashBytes);
+		case EHashAlgorithm::CRC32C: return MakeUnique<THashAlgorithm<CRC32C>>(CRC32C::HashBytes);
+		case EHashAlgorithm::SHA512: return MakeUnique<THashAlgorithm<SHA512>>(SHA512::HashBytes);
+		case EHashAlgorithm::SHA384: return MakeUnique<THashAlgorithm<SHA384>>(SHA384::HashBytes);
+		case EHashAlgorithm::SHA512_256: return MakeUnique<THashAlgorithm<SHA512_256>>(SHA512_256::HashBytes);
+		case EHashAlgorithm::BLAKE3: return MakeUnique<THashAlgorithm<BLAKE3>>(BLAKE3::HashBytes);
+		default: return nullptr;
+	}
+}
@@ -0,0 +1,70 @@
+// Copyright 2022 Chris Ringenberg https://www.ringenberg.dev/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BlueprintEncryptionTypes.h"
+
+/**
+ * Type erased wrapper around the incremental interface (add / getHash / reset) of the hash-library classes
+ */
+class IHashAlgorithm
+{
+public:
+
+	virtual ~IHashAlgorithm() = default;
+
+	virtual void Add(const void* Data, size_t NumBytes) = 0;
+
+	// Digest of everything added since the last reset as lowercase hex, the state is left untouched
+	virtual UE_NODISCARD FString GetHash() = 0;
+
+	// Same as GetHash(), but the raw digest
+	virtual UE_NODISCARD TArray<uint8> GetHashBytes() = 0;
+
+	virtual void Reset() = 0;
+
+	static UE_NODISCARD TUniquePtr<IHashAlgorithm> Create(EHashAlgorithm Algorithm);
+};
+
+template <typename HashType>
+class THashAlgorithm final : public IHashAlgorithm
+{
+public:
+
+	template <typename... ArgTypes>
+	explicit THashAlgorithm(const int32 InDigestSize, ArgTypes... Args)
+		: Hash(Args...)
+		, DigestSize(InDigestSize)
+	{
+	}
+
+	virtual void Add(const void* Data, const size_t NumBytes) override
+	{
+		Hash.add(Data, NumBytes);
+	}
+
+	virtual FString GetHash() override
+	{
+		return Hash.getHash().c_str();
+	}
+
+	virtual TArray<uint8> GetHashBytes() override
+	{
+		TArray<uint8> Digest;
+		Digest.SetNumUninitialized(DigestSize);
+		Hash.getHash(Digest.GetData());
+		return Digest;
+	}
+
+	virtual void Reset() override
+	{
+		Hash.reset();
+	}
+
+private:
+
+	HashType Hash;
+
+	int32 DigestSize;
+};
@@ -0,0 +1,9 @@
+// Copyright 2022 Chris Ringenberg https://www.ringenberg.dev/
+
+// Compiles hash-library/Private/cpufeatures.cpp as part of this module, see BlueprintEncryption.Build.cs
+
+#include "CoreMinimal.h"
+
+THIRD_PARTY_INCLUDES_START
+#include "hash-library/Private/cpufeatures.cpp"
+THIRD_PARTY_INCLUDES_END
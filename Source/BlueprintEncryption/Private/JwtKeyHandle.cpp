@@ -0,0 +1,111 @@
+// Copyright 2022 Chris Ringenberg https://www.ringenberg.dev/
+
+#include "JwtKeyHandle.h"
+
+URSAKeyHandle* URSAKeyHandle::Create(const FString& InKeyId, const std::string& PublicKey, const std::string& PrivateKey,
+                                     const std::string& PublicKeyPassword, const std::string& PrivateKeyPassword,
+                                     const ERSAlgorithm InAlgorithm)
+{
+	URSAKeyHandle* Handle = NewObject<URSAKeyHandle>();
+	Handle->KeyId = InKeyId;
+	Handle->AlgorithmType = InAlgorithm;
+
+	const std::shared_ptr<EVP_PKEY> Key = !PrivateKey.empty()
+		                                      ? jwt::helper::load_private_key_from_string(PrivateKey, PrivateKeyPassword)
+		                                      : jwt::helper::load_public_key_from_string(PublicKey, PublicKeyPassword);
+	if (!Key)
+	{
+		return Handle;
+	}
+
+	switch (InAlgorithm)
+	{
+		case ERSAlgorithm::rs256: Handle->Algorithm.Emplace(Key, EVP_sha256, "RS256"); break;
+		case ERSAlgorithm::rs384: Handle->Algorithm.Emplace(Key, EVP_sha384, "RS384"); break;
+		case ERSAlgorithm::rs512: Handle->Algorithm.Emplace(Key, EVP_sha512, "RS512"); break;
+		default: break;
+	}
+
+	return Handle;
+}
+
+bool URSAKeyHandle::IsValidKey() const
+{
+	return Algorithm.IsSet();
+}
+
+std::string URSAKeyHandle::GetAlgorithmName() const
+{
+	return Algorithm.IsSet() ? Algorithm->name() : std::string();
+}
+
+std::string URSAKeyHandle::Sign(const std::string& Data) const
+{
+	return Algorithm.IsSet() ? Algorithm->sign(Data) : std::string();
+}
+
+void URSAKeyHandle::Sign(const std::string& Data, std::string& OutSignature) const
+{
+	if (Algorithm.IsSet())
+	{
+		Algorithm->sign(Data, OutSignature);
+	}
+	else
+	{
+		OutSignature.clear();
+	}
+}
+
+bool URSAKeyHandle::Verify(const std::string_view Data, const std::string_view Signature) const
+{
+	return Algorithm.IsSet() && Algorithm->verify(Data, Signature);
+}
+
+UHMACKeyHandle* UHMACKeyHandle::Create(const FString& InKeyId, const std::string& Secret, const EHSAlgorithm InAlgorithm)
+{
+	UHMACKeyHandle* Handle = NewObject<UHMACKeyHandle>();
+	Handle->KeyId = InKeyId;
+	Handle->AlgorithmType = InAlgorithm;
+
+	switch (InAlgorithm)
+	{
+		case EHSAlgorithm::hs256: Handle->Algorithm.Emplace(Secret, EVP_sha256, "HS256"); break;
+		case EHSAlgorithm::hs384: Handle->Algorithm.Emplace(Secret, EVP_sha384, "HS384"); break;
+		case EHSAlgorithm::hs512: Handle->Algorithm.Emplace(Secret, EVP_sha512, "HS512"); break;
+		default: break;
+	}
+
+	return Handle;
+}
+
+bool UHMACKeyHandle::IsValidKey() const
+{
+	return Algorithm.IsSet();
+}
+
+std::string UHMACKeyHandle::GetAlgorithmName() const
+{
+	return Algorithm.IsSet() ? Algorithm->name() : std::string();
+}
+
+std::string UHMACKeyHandle::Sign(const std::string& Data) const
+{
+	return Algorithm.IsSet() ? Algorithm->sign(Data) : std::string();
+}
+
+void UHMACKeyHandle::Sign(const std::string& Data, std::string& OutSignature) const
+{
+	if (Algorithm.IsSet())
+	{
+		Algorithm->sign(Data, OutSignature);
+	}
+	else
+	{
+		OutSignature.clear();
+	}
+}
+
+bool UHMACKeyHandle::Verify(const std::string_view Data, const std::string_view Signature) const
+{
+	return Algorithm.IsSet() && Algorithm->verify(Data, Signature);
+}
@@ -0,0 +1,73 @@
+// Copyright 2022 Chris Ringenberg https://www.ringenberg.dev/
+
+#include "JwtTokenWriter.h"
+
+#include "JwtKeyHandle.h"
+
+#include "jwt.h"
+
+void FJwtTokenWriter::Reset(const UJwtKeyHandle& InKey, const int64 InIssuedAt)
+{
+	Key = &InKey;
+	IssuedAt = InIssuedAt;
+
+	Token.assign("{\"alg\":\"");
+	Token += Key->GetAlgorithmName();
+	Token += "\",\"typ\":\"JWT\"}";
+	jwt::base::encode<jwt::alphabet::base64url>(Token.data(), Token.size(), EncodedHeader, false);
+	EncodedHeader += '.';
+
+	IssuedAtClaim.assign(",\"iat\":");
+	IssuedAtClaim += std::to_string(IssuedAt);
+}
+
+std::string& FJwtTokenWriter::BeginPayload(const int32 ExpiresAt, const bool bWriteIssuedAt, const bool bWriteExpiresAt)
+{
+	// every claim is written with a leading comma, the first one is removed by Finish()
+	Json.assign("{");
+	if (bWriteIssuedAt)
+	{
+		Json += IssuedAtClaim;
+	}
+	if (bWriteExpiresAt)
+	{
+		Json += ",\"exp\":";
+		Json += std::to_string(IssuedAt + ExpiresAt);
+	}
+	return Json;
+}
+
+void FJwtTokenWriter::WriteClaim(const TCHAR* Name, const FString& Value)
+{
+	Json += ',';
+	WriteString(Name, Json);
+	Json += ':';
+	WriteString(Value, Json);
+}
+
+FString FJwtTokenWriter::Finish()
+{
+	check(Key);
+
+	if (Json.size() > 1)
+	{
+		Json.erase(1, 1);
+	}
+	Json += '}';
+
+	Token.assign(EncodedHeader);
+	jwt::base::encode<jwt::alphabet::base64url>(Json.data(), Json.size(), Encoded, false);
+	Token += Encoded;
+	Key->Sign(Token, Signature);
+	jwt::base::encode<jwt::alphabet::base64url>(Signature.data(), Signature.size(), Encoded, false);
+	Token += '.';
+	Token += Encoded;
+
+	return Token.c_str();
+}
+
+void FJwtTokenWriter::WriteString(const TCHAR* String, std::string& Out)
+{
+	const FTCHARToUTF8 Utf8(String);
+	jwt::flat_json::serialize_string(std::string_view(Utf8.Get(), Utf8.Length()), Out);
+}
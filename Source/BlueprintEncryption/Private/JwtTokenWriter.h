@@ -0,0 +1,56 @@
+// Copyright 2022 Chris Ringenberg https://www.ringenberg.dev/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include <string>
+
+class UJwtKeyHandle;
+
+/**
+ * Assembles signed tokens in buffers that are reused from one token to the next, so the caller only writes its own claims.
+ * Not thread safe, use one writer per thread
+ */
+class FJwtTokenWriter
+{
+public:
+
+	// Encodes the header for Key, every following token is signed with it and issued at IssuedAt
+	void Reset(const UJwtKeyHandle& InKey, int64 IssuedAt);
+
+	// Starts the payload of a new token with the iat and exp claims, unless the caller writes its own.
+	// Returns the json of the payload, every claim appended to it has to start with a comma
+	std::string& BeginPayload(int32 ExpiresAt, bool bWriteIssuedAt, bool bWriteExpiresAt);
+
+	// Appends ,"Name":"Value" to the payload
+	void WriteClaim(const TCHAR* Name, const FString& Value);
+
+	// Closes the payload, then encodes and signs the token
+	UE_NODISCARD FString Finish();
+
+	// Appends String as a quoted and escaped json string
+	static void WriteString(const TCHAR* String, std::string& Out);
+
+	static void WriteString(const FString& String, std::string& Out) { WriteString(*String, Out); }
+
+private:
+
+	const UJwtKeyHandle* Key = nullptr;
+
+	int64 IssuedAt = 0;
+
+	// base64url of the header, followed by the dot
+	std::string EncodedHeader;
+
+	// ,"iat":<IssuedAt>
+	std::string IssuedAtClaim;
+
+	std::string Json;
+
+	std::string Token;
+
+	std::string Encoded;
+
+	std::string Signature;
+};
@@ -0,0 +1,309 @@
+// Copyright 2022 Chris Ringenberg https://www.ringenberg.dev/
+
+#include "JwtVerifier.h"
+
+#include "BlueprintJWTLibrary.h"
+#include "JwtKeyHandle.h"
+
+#include "Async/ParallelFor.h"
+
+#include "Containers/LruCache.h"
+
+#include "Hash/CityHash.h"
+
+/**
+ * Tokens that passed verification, split into shards so threads verifying different tokens rarely wait on each other
+ */
+class FVerifiedTokenCache
+{
+public:
+
+	explicit FVerifiedTokenCache(const int32 MaxNumTokens)
+		: MaxNumTokensPerShard(FMath::DivideAndRoundUp(MaxNumTokens, NumShards))
+	{
+		Empty();
+	}
+
+	// True if the token is cached and still valid at Now, OutPayload may be nullptr
+	bool Find(const uint64 TokenHash, const std::string_view Token, const int64 Now, jwt::claims_document* OutPayload)
+	{
+		FShard& Shard = GetShard(TokenHash);
+		TSharedPtr<const jwt::claims_document, ESPMode::ThreadSafe> Payload;
+		{
+			FScopeLock Lock(&Shard.Lock);
+			const FEntry* Entry = Shard.Tokens.FindAndTouch(TokenHash);
+			// the hash only picks the slot, the token itself has to match
+			if (!Entry || Entry->Token != Token)
+			{
+				return false;
+			}
+			if (Now > Entry->ValidUntil)
+			{
+				Shard.Tokens.Remove(TokenHash);
+				return false;
+			}
+			Payload = Entry->Payload;
+		}
+
+		if (OutPayload)
+		{
+			*OutPayload = *Payload;
+		}
+		return true;
+	}
+
+	void Add(const uint64 TokenHash, const std::string_view Token, const int64 ValidUntil,
+	         const TSharedRef<const jwt::claims_document, ESPMode::ThreadSafe>& Payload)
+	{
+		FShard& Shard = GetShard(TokenHash);
+		FScopeLock Lock(&Shard.Lock);
+		Shard.Tokens.Add(TokenHash, {std::string(Token), ValidUntil, Payload});
+	}
+
+	void Empty()
+	{
+		for (FShard& Shard : Shards)
+		{
+			FScopeLock Lock(&Shard.Lock);
+			Shard.Tokens.Empty(MaxNumTokensPerShard);
+		}
+	}
+
+private:
+
+	struct FEntry
+	{
+		std::string Token;
+		int64 ValidUntil;
+		TSharedPtr<const jwt::claims_document, ESPMode::ThreadSafe> Payload;
+	};
+
+	struct FShard
+	{
+		FCriticalSection Lock;
+		TLruCache<uint64, FEntry> Tokens;
+	};
+
+	static constexpr int32 NumShards = 16;
+
+	// the low bits already pick the bucket inside the shard
+	FShard& GetShard(const uint64 TokenHash)
+	{
+		return Shards[TokenHash >> 60];
+	}
+
+	int32 MaxNumTokensPerShard;
+
+	FShard Shards[NumShards];
+};
+
+UJwtVerifier::~UJwtVerifier() = default;
+
+UJwtVerifier* UJwtVerifier::CreateJwtVerifier(const TArray<UJwtKeyHandle*>& Keys, const FString& Issuer,
+                                              const FString& Audience, const int32 LeewaySeconds, const int32 CacheSize)
+{
+	UJwtVerifier* Verifier = NewObject<UJwtVerifier>();
+	Verifier->Issuer = TCHAR_TO_UTF8(*Issuer);
+	Verifier->Audience = TCHAR_TO_UTF8(*Audience);
+	Verifier->Leeway = FMath::Max(LeewaySeconds, 0);
+
+	for (UJwtKeyHandle* Key : Keys)
+	{
+		if (!Key || !Key->IsValidKey())
+		{
+			continue;
+		}
+
+		Verifier->Keys.Add(Key);
+		Verifier->KeyEntries.Add({Key->GetAlgorithmName(), TCHAR_TO_UTF8(*Key->GetKeyId()), Key});
+		Verifier->bHasAsymmetricKey |= Key->IsAsymmetric();
+	}
+
+	if (CacheSize > 0)
+	{
+		Verifier->Cache = MakeUnique<FVerifiedTokenCache>(CacheSize);
+	}
+
+	return Verifier;
+}
+
+bool UJwtVerifier::Verify(const FString& Token, TMap<FString, FString>& Claims) const
+{
+	Claims.Reset();
+
+	const FTCHARToUTF8 Utf8(*Token);
+	jwt::claims_document Payload;
+	if (!VerifyToken(std::string_view(Utf8.Get(), Utf8.Length()), &Payload))
+	{
+		return false;
+	}
+
+	Claims.Reserve(Payload.size());
+	Payload.for_each_json([&Claims](const std::string_view Name, const std::string& Json)
+	{
+		const FUTF8ToTCHAR Key(Name.data(), Name.size());
+		Claims.Add(FString(Key.Length(), Key.Get()), UTF8_TO_TCHAR(Json.c_str()));
+	});
+
+	return true;
+}
+
+bool UJwtVerifier::VerifyTyped(const FString& Token, TMap<FString, FJwtClaimValue>& Claims) const
+{
+	Claims.Reset();
+
+	const FTCHARToUTF8 Utf8(*Token);
+	jwt::claims_document Payload;
+	if (!VerifyToken(std::string_view(Utf8.Get(), Utf8.Length()), &Payload))
+	{
+		return false;
+	}
+
+	UBlueprintJwtLibrary::ReadClaims(Payload, Claims);
+	return true;
+}
+
+TArray<bool> UJwtVerifier::VerifyBatch(const TArray<FString>& Tokens) const
+{
+	TArray<bool> OutResults;
+	OutResults.SetNumZeroed(Tokens.Num());
+
+	const auto VerifyRange = [&](const int32 Begin, const int32 End)
+	{
+		for (int32 Index = Begin; Index < End; ++Index)
+		{
+			const FTCHARToUTF8 Utf8(*Tokens[Index]);
+			OutResults[Index] = VerifyToken(std::string_view(Utf8.Get(), Utf8.Length()));
+		}
+	};
+
+	const int32 NumTasks = bHasAsymmetricKey
+		                       ? FMath::Min(Tokens.Num(), FTaskGraphInterface::Get().GetNumWorkerThreads() + 1)
+		                       : 1;
+	if (NumTasks > 1)
+	{
+		ParallelFor(NumTasks, [&](const int32 Task)
+		{
+			VerifyRange(Tokens.Num() * Task / NumTasks, Tokens.Num() * (Task + 1) / NumTasks);
+		});
+	}
+	else
+	{
+		VerifyRange(0, Tokens.Num());
+	}
+
+	return OutResults;
+}
+
+void UJwtVerifier::ClearCache()
+{
+	if (Cache)
+	{
+		Cache->Empty();
+	}
+}
+
+bool UJwtVerifier::VerifyToken(const std::string_view Token, jwt::claims_document* OutPayload) const
+{
+	const int64 Now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+	const uint64 TokenHash = Cache ? CityHash64(Token.data(), Token.size()) : 0;
+	// same leeway on exp as in VerifyClaims, everything else was already checked when the token was cached
+	if (Cache && Cache->Find(TokenHash, Token, Now - Leeway, OutPayload))
+	{
+		return true;
+	}
+
+	// reused by every token verified on this thread, so decoding and parsing don't allocate once they have grown large enough
+	thread_local jwt::decoded_jwt_view Decoded;
+	thread_local jwt::claims_document Header;
+	std::string_view Algorithm;
+	if (!Decoded.parse(Token) || !Header.parse(Decoded.get_header()) || !Header.get_string("alg", Algorithm))
+	{
+		return false;
+	}
+
+	std::string_view KeyId;
+	const bool bHasKeyId = Header.has("kid");
+	if (bHasKeyId && !Header.get_string("kid", KeyId))
+	{
+		return false;
+	}
+
+	// the payload is only parsed once it is known to come from a trusted issuer
+	if (!VerifySignature(Algorithm, bHasKeyId ? &KeyId : nullptr, Decoded.get_signed_data(), Decoded.get_signature()))
+	{
+		return false;
+	}
+
+	thread_local jwt::claims_document ScratchPayload;
+	jwt::claims_document& Payload = OutPayload ? *OutPayload : ScratchPayload;
+	int64 ExpiresAt;
+	if (!Payload.parse(Decoded.get_payload()) || !VerifyClaims(Payload, Now, ExpiresAt))
+	{
+		return false;
+	}
+
+	if (Cache)
+	{
+		Cache->Add(TokenHash, Token, ExpiresAt, MakeShared<const jwt::claims_document, ESPMode::ThreadSafe>(Payload));
+	}
+
+	return true;
+}
+
+bool UJwtVerifier::VerifySignature(const std::string_view Algorithm, const std::string_view* KeyId, const std::string_view Data,
+                                   const std::string_view Signature) const
+{
+	if (KeyId)
+	{
+		for (const FKeyEntry& Entry : KeyEntries)
+		{
+			if (Entry.KeyId == *KeyId)
+			{
+				return Entry.Algorithm == Algorithm && Entry.Key->Verify(Data, Signature);
+			}
+		}
+	}
+
+	for (const FKeyEntry& Entry : KeyEntries)
+	{
+		if (Entry.Algorithm == Algorithm && Entry.Key->Verify(Data, Signature))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool UJwtVerifier::VerifyClaims(const jwt::claims_document& Payload, const int64 Now, int64& OutExpiresAt) const
+{
+	OutExpiresAt = MAX_int64;
+
+	int64_t Time;
+	if (Payload.has("exp"))
+	{
+		if (!Payload.get_time("exp", Time) || Now - Leeway > Time)
+		{
+			return false;
+		}
+		OutExpiresAt = Time;
+	}
+	if (Payload.has("nbf") && (!Payload.get_time("nbf", Time) || Now + Leeway < Time))
+	{
+		return false;
+	}
+	if (Payload.has("iat") && (!Payload.get_time("iat", Time) || Now + Leeway < Time))
+	{
+		return false;
+	}
+
+	std::string_view ClaimIssuer;
+	if (!Issuer.empty() && (!Payload.get_string("iss", ClaimIssuer) || ClaimIssuer != Issuer))
+	{
+		return false;
+	}
+
+	// "aud" is either a single string or an array of them
+	return Audience.empty() || Payload.contains("aud", Audience);
+}
@@ -0,0 +1,97 @@
+// Copyright 2022 Chris Ringenberg https://www.ringenberg.dev/
+
+#include "MappedFileReader.h"
+
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFilemanager.h"
+
+#if PLATFORM_UNIX || PLATFORM_MAC
+#include <sys/mman.h>
+#endif
+
+namespace
+{
+	// Mapping in windows keeps the address space and page table usage bounded for very large files
+	constexpr int64 MapWindowSize = 64 * 1024 * 1024;
+
+	// Small enough to stay cache resident between reading and hashing
+	constexpr int64 ReadBufferSize = 1024 * 1024;
+}
+
+bool FMappedFileReader::Read(const FString& FilePath, const TFunctionRef<void(const uint8* Data, int64 NumBytes)> Consumer)
+{
+	const int64 FileSize = FPlatformFileManager::Get().GetPlatformFile().FileSize(*FilePath);
+	if (FileSize < 0)
+	{
+		return false;
+	}
+
+	// empty files can't be mapped
+	if (FileSize == 0)
+	{
+		return true;
+	}
+
+	const int64 NumMapped = ReadMapped(FilePath, FileSize, Consumer);
+	return NumMapped == FileSize || ReadBuffered(FilePath, NumMapped, FileSize, Consumer);
+}
+
+int64 FMappedFileReader::ReadMapped(const FString& FilePath, const int64 FileSize, const TFunctionRef<void(const uint8*, int64)> Consumer)
+{
+	const TUniquePtr<IMappedFileHandle> MappedFile(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*FilePath));
+	if (!MappedFile)
+	{
+		return 0;
+	}
+
+	int64 Offset = 0;
+	for (; Offset < FileSize; Offset += MapWindowSize)
+	{
+		const int64 NumBytes = FMath::Min(MapWindowSize, FileSize - Offset);
+		const TUniquePtr<IMappedFileRegion> Region(MappedFile->MapRegion(Offset, NumBytes));
+		if (!Region)
+		{
+			break;
+		}
+
+		const uint8* Data = Region->GetMappedPtr();
+
+#if PLATFORM_UNIX || PLATFORM_MAC
+		// madvise() requires a page aligned address, the region may start in the middle of a page
+		const UPTRINT PageSize = FPlatformMemory::GetConstants().PageSize;
+		const UPTRINT AlignedBegin = AlignDown(reinterpret_cast<UPTRINT>(Data), PageSize);
+		const SIZE_T AlignedSize = reinterpret_cast<UPTRINT>(Data) + NumBytes - AlignedBegin;
+		madvise(reinterpret_cast<void*>(AlignedBegin), AlignedSize, MADV_SEQUENTIAL);
+#endif
+
+		Consumer(Data, NumBytes);
+	}
+
+	return FMath::Min(Offset, FileSize);
+}
+
+bool FMappedFileReader::ReadBuffered(const FString& FilePath, int64 Offset, const int64 FileSize, const TFunctionRef<void(const uint8*, int64)> Consumer)
+{
+	const TUniquePtr<IFileHandle> FileHandle(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*FilePath));
+	if (!FileHandle || !FileHandle->Seek(Offset))
+	{
+		return false;
+	}
+
+	TArray<uint8> Buffer;
+	Buffer.SetNumUninitialized(FMath::Min(ReadBufferSize, FileSize - Offset));
+
+	while (Offset < FileSize)
+	{
+		const int64 NumBytes = FMath::Min<int64>(Buffer.Num(), FileSize - Offset);
+		if (!FileHandle->Read(Buffer.GetData(), NumBytes))
+		{
+			return false;
+		}
+
+		Consumer(Buffer.GetData(), NumBytes);
+		Offset += NumBytes;
+	}
+
+	return true;
+}
@@ -0,0 +1,24 @@
+// Copyright 2022 Chris Ringenberg https://www.ringenberg.dev/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Streams a file through a callback without loading it into memory first
+ */
+class FMappedFileReader
+{
+public:
+
+	// Calls Consumer for consecutive chunks of the file, in order. The file is memory mapped window by window
+	// if the platform supports it, otherwise it is read into a small buffer. Returns false if the file can't be read
+	static UE_NODISCARD bool Read(const FString& FilePath, TFunctionRef<void(const uint8* Data, int64 NumBytes)> Consumer);
+
+private:
+
+	// Returns the number of bytes passed to Consumer, less than FileSize if mapping isn't possible (anymore)
+	static UE_NODISCARD int64 ReadMapped(const FString& FilePath, int64 FileSize, TFunctionRef<void(const uint8*, int64)> Consumer);
+
+	static UE_NODISCARD bool ReadBuffered(const FString& FilePath, int64 Offset, int64 FileSize, TFunctionRef<void(const uint8*, int64)> Consumer);
+};
@@ -0,0 +1,52 @@
+// Copyright 2022 Chris Ringenberg https://www.ringenberg.dev/
+
+#include "StreamingHasher.h"
+
+#include "HashAlgorithm.h"
+
+UStreamingHasher::~UStreamingHasher() = default;
+
+UStreamingHasher* UStreamingHasher::CreateStreamingHasher(const EHashAlgorithm Algorithm)
+{
+	UStreamingHasher* Hasher = NewObject<UStreamingHasher>();
+	Hasher->Algorithm = Algorithm;
+	Hasher->Hash = IHashAlgorithm::Create(Algorithm);
+	return Hasher;
+}
+
+void UStreamingHasher::Update(const TArray<uint8>& BinaryData)
+{
+	UpdateBytes(BinaryData.GetData(), BinaryData.Num());
+}
+
+void UStreamingHasher::UpdateString(const FString& Data)
+{
+	const FTCHARToUTF8 Utf8(*Data);
+	UpdateBytes(Utf8.Get(), Utf8.Length());
+}
+
+void UStreamingHasher::UpdateBytes(const void* Data, const size_t NumBytes)
+{
+	if (Hash)
+	{
+		Hash->Add(Data, NumBytes);
+	}
+}
+
+FString UStreamingHasher::Finalize()
+{
+	return Hash ? Hash->GetHash() : FString();
+}
+
+TArray<uint8> UStreamingHasher::FinalizeBytes()
+{
+	return Hash ? Hash->GetHashBytes() : TArray<uint8>();
+}
+
+void UStreamingHasher::Reset()
+{
+	if (Hash)
+	{
+		Hash->Reset();
+	}
+}
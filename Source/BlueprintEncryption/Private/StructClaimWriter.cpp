@@ -0,0 +1,238 @@
+// Copyright 2022 Chris Ringenberg https://www.ringenberg.dev/
+
+#include "StructClaimWriter.h"
+
+#include "JwtTokenWriter.h"
+
+#include "JsonObjectConverter.h"
+
+#include "Engine/UserDefinedStruct.h"
+
+#include "Misc/ScopeRWLock.h"
+
+#include "Serialization/JsonSerializer.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+	FRWLock WritersLock;
+
+	TMap<const UScriptStruct*, TSharedRef<const FStructClaimWriter, ESPMode::ThreadSafe>> Writers;
+}
+
+TSharedRef<const FStructClaimWriter, ESPMode::ThreadSafe> FStructClaimWriter::Get(const UScriptStruct* Struct)
+{
+	check(Struct);
+
+#if WITH_EDITOR
+	// the properties of user defined structs change whenever the struct is edited
+	if (Struct->IsA<UUserDefinedStruct>())
+	{
+		return MakeShareable(new FStructClaimWriter(Struct));
+	}
+#endif
+
+	{
+		FRWScopeLock Lock(WritersLock, SLT_ReadOnly);
+		const TSharedRef<const FStructClaimWriter, ESPMode::ThreadSafe>* Writer = Writers.Find(Struct);
+		// a struct that was garbage collected may have left its address to a new one
+		if (Writer && (*Writer)->Struct.Get() == Struct)
+		{
+			return *Writer;
+		}
+	}
+
+	TSharedRef<const FStructClaimWriter, ESPMode::ThreadSafe> Writer = MakeShareable(new FStructClaimWriter(Struct));
+	FRWScopeLock Lock(WritersLock, SLT_Write);
+	Writers.Add(Struct, Writer);
+	return Writer;
+}
+
+FStructClaimWriter::FStructClaimWriter(const UScriptStruct* InStruct)
+	: Struct(InStruct)
+{
+	for (TFieldIterator<FProperty> It(InStruct); It; ++It)
+	{
+		const FProperty* Property = *It;
+		// same names as SerializeStructToString
+		const FString Name = FJsonObjectConverter::StandardizeCase(Property->GetAuthoredName());
+
+		FClaim Claim;
+		Claim.Property = Property;
+		Claim.Prefix = ",";
+		FJwtTokenWriter::WriteString(Name, Claim.Prefix);
+		Claim.Prefix += ':';
+
+		// fixed size arrays are left to FJsonObjectConverter
+		Claim.Value = Property->ArrayDim == 1 ? MakeValueWriter(Property) : FValueWriter{EKind::Other, Property, nullptr};
+		Claim.Element = {EKind::Other, nullptr, nullptr};
+		if (Claim.Value.Kind == EKind::Array)
+		{
+			const FProperty* Inner = CastFieldChecked<const FArrayProperty>(Property)->Inner;
+			Claim.Element = MakeValueWriter(Inner);
+			if (Claim.Element.Kind == EKind::Array)
+			{
+				Claim.Element.Kind = EKind::Other;
+			}
+		}
+
+		Claims.Add(MoveTemp(Claim));
+		ClaimNames.Add(Name);
+	}
+}
+
+bool FStructClaimWriter::HasClaim(const FString& Name) const
+{
+	// FString's operator== ignores case, so "EXP" would hide "exp"
+	return ClaimNames.ContainsByPredicate([&Name](const FString& ClaimName)
+	{
+		return ClaimName.Equals(Name, ESearchCase::CaseSensitive);
+	});
+}
+
+FStructClaimWriter::FValueWriter FStructClaimWriter::MakeValueWriter(const FProperty* Property)
+{
+	if (Property->IsA<FBoolProperty>())
+	{
+		return {EKind::Bool, Property, nullptr};
+	}
+	if (const FEnumProperty* EnumProperty = CastField<const FEnumProperty>(Property))
+	{
+		return {EKind::Enum, EnumProperty->GetUnderlyingProperty(), EnumProperty->GetEnum()};
+	}
+	if (const FByteProperty* ByteProperty = CastField<const FByteProperty>(Property))
+	{
+		if (ByteProperty->Enum)
+		{
+			return {EKind::Enum, Property, ByteProperty->Enum};
+		}
+	}
+	if (Property->IsA<FFloatProperty>())
+	{
+		return {EKind::Float, Property, nullptr};
+	}
+	if (Property->IsA<FDoubleProperty>())
+	{
+		return {EKind::Double, Property, nullptr};
+	}
+	if (Property->IsA<FByteProperty>() || Property->IsA<FUInt16Property>() || Property->IsA<FUInt32Property>() ||
+		Property->IsA<FUInt64Property>())
+	{
+		return {EKind::UnsignedInteger, Property, nullptr};
+	}
+	if (Property->IsA<FInt8Property>() || Property->IsA<FInt16Property>() || Property->IsA<FIntProperty>() ||
+		Property->IsA<FInt64Property>())
+	{
+		return {EKind::SignedInteger, Property, nullptr};
+	}
+	if (Property->IsA<FStrProperty>())
+	{
+		return {EKind::String, Property, nullptr};
+	}
+	if (Property->IsA<FNameProperty>())
+	{
+		return {EKind::Name, Property, nullptr};
+	}
+	if (Property->IsA<FTextProperty>())
+	{
+		return {EKind::Text, Property, nullptr};
+	}
+	if (Property->IsA<FArrayProperty>())
+	{
+		return {EKind::Array, Property, nullptr};
+	}
+	return {EKind::Other, Property, nullptr};
+}
+
+void FStructClaimWriter::Write(const void* StructData, std::string& Out) const
+{
+	for (const FClaim& Claim : Claims)
+	{
+		Out += Claim.Prefix;
+
+		const void* Value = Claim.Property->ContainerPtrToValuePtr<void>(StructData);
+		if (Claim.Value.Kind != EKind::Array)
+		{
+			WriteValue(Claim.Value, Value, Out);
+			continue;
+		}
+
+		FScriptArrayHelper Array(CastFieldChecked<const FArrayProperty>(Claim.Property), Value);
+		Out += '[';
+		for (int32 Index = 0; Index < Array.Num(); ++Index)
+		{
+			if (Index > 0)
+			{
+				Out += ',';
+			}
+			WriteValue(Claim.Element, Array.GetRawPtr(Index), Out);
+		}
+		Out += ']';
+	}
+}
+
+void FStructClaimWriter::WriteValue(const FValueWriter& Writer, const void* Value, std::string& Out)
+{
+	char Buffer[32];
+	switch (Writer.Kind)
+	{
+		case EKind::Bool:
+			Out += CastFieldChecked<const FBoolProperty>(Writer.Property)->GetPropertyValue(Value) ? "true" : "false";
+			break;
+		case EKind::SignedInteger:
+			Out += std::to_string(CastFieldChecked<const FNumericProperty>(Writer.Property)->GetSignedIntPropertyValue(Value));
+			break;
+		case EKind::UnsignedInteger:
+			Out += std::to_string(CastFieldChecked<const FNumericProperty>(Writer.Property)->GetUnsignedIntPropertyValue(Value));
+			break;
+		case EKind::Float:
+		case EKind::Double:
+		{
+			const double Number = Writer.Kind == EKind::Float ? *static_cast<const float*>(Value) : *static_cast<const double*>(Value);
+			// json has no representation for them, FJsonObjectConverter doesn't either
+			if (!std::isfinite(Number))
+			{
+				Out += "null";
+				break;
+			}
+			// shortest precision that still reads back the same value
+			const int32 Length = snprintf(Buffer, sizeof(Buffer), Writer.Kind == EKind::Float ? "%.9g" : "%.17g", Number);
+			Out.append(Buffer, Length);
+			break;
+		}
+		case EKind::String:
+			FJwtTokenWriter::WriteString(*static_cast<const FString*>(Value), Out);
+			break;
+		case EKind::Name:
+			FJwtTokenWriter::WriteString(static_cast<const FName*>(Value)->ToString(), Out);
+			break;
+		case EKind::Text:
+			FJwtTokenWriter::WriteString(static_cast<const FText*>(Value)->ToString(), Out);
+			break;
+		case EKind::Enum:
+		{
+			const int64 EnumValue = CastFieldChecked<const FNumericProperty>(Writer.Property)->GetSignedIntPropertyValue(Value);
+			FJwtTokenWriter::WriteString(Writer.Enum->GetNameStringByValue(EnumValue), Out);
+			break;
+		}
+		default:
+		{
+			const TSharedPtr<FJsonValue> JsonValue = FJsonObjectConverter::UPropertyToJsonValue(const_cast<FProperty*>(Writer.Property), Value);
+			// the json writer only accepts objects and arrays at the top, so the value is wrapped into an array
+			const TArray<TSharedPtr<FJsonValue>> Wrapped{JsonValue};
+			FString Json;
+			const TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> JsonWriter =
+				TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Json);
+			if (!JsonValue.IsValid() || !FJsonSerializer::Serialize(Wrapped, JsonWriter) || Json.Len() < 2)
+			{
+				Out += "null";
+				break;
+			}
+			const FTCHARToUTF8 Utf8(*Json + 1, Json.Len() - 2);
+			Out.append(Utf8.Get(), Utf8.Length());
+			break;
+		}
+	}
+}
@@ -0,0 +1,74 @@
+// Copyright 2022 Chris Ringenberg https://www.ringenberg.dev/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include <string>
+
+/**
+ * Writes the properties of a struct as JWT payload claims, straight into the json text of the payload.
+ * The properties are reflected over once per struct, encoding a struct afterwards only walks the cached plan
+ */
+class FStructClaimWriter
+{
+public:
+
+	// Returns the writer of the struct, it is built on first use and then shared. Safe to call from any thread
+	static UE_NODISCARD TSharedRef<const FStructClaimWriter, ESPMode::ThreadSafe> Get(const UScriptStruct* Struct);
+
+	// Appends every property of StructData as a json member, each one preceded by a comma
+	void Write(const void* StructData, std::string& Out) const;
+
+	// True if the struct has a property named after the claim, e.g. "exp". Claim names are case sensitive
+	UE_NODISCARD bool HasClaim(const FString& Name) const;
+
+private:
+
+	enum class EKind : uint8
+	{
+		Bool,
+		SignedInteger,
+		UnsignedInteger,
+		Float,
+		Double,
+		String,
+		Name,
+		Text,
+		Enum,
+		Array,
+		// anything else is converted by FJsonObjectConverter
+		Other
+	};
+
+	struct FValueWriter
+	{
+		EKind Kind;
+		const FProperty* Property;
+		// names written for Enum values
+		const UEnum* Enum;
+	};
+
+	struct FClaim
+	{
+		// ,"name":
+		std::string Prefix;
+		// the struct member, locates the value. Value.Property may be an inner property at offset 0 (enum class members)
+		const FProperty* Property;
+		FValueWriter Value;
+		// only used for Array
+		FValueWriter Element;
+	};
+
+	explicit FStructClaimWriter(const UScriptStruct* InStruct);
+
+	static UE_NODISCARD FValueWriter MakeValueWriter(const FProperty* Property);
+
+	static void WriteValue(const FValueWriter& Writer, const void* Value, std::string& Out);
+
+	TWeakObjectPtr<const UScriptStruct> Struct;
+
+	TArray<FClaim> Claims;
+
+	TArray<FString> ClaimNames;
+};
@@ -0,0 +1,52 @@
+// Copyright 2022 Chris Ringenberg https://www.ringenberg.dev/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BlueprintEncryptionTypes.h"
+
+#include "Kismet/BlueprintAsyncActionBase.h"
+
+#include "AsyncHashAction.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FAsyncHashCompleted, const FString&, Digest);
+
+/**
+ * Hashes on the thread pool and reports the digest back on the game thread, so large inputs don't stall a frame
+ */
+UCLASS()
+class BLUEPRINTENCRYPTION_API UAsyncHashAction final : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+
+	// Called on the game thread with the digest as lowercase hex, or an empty string if a file couldn't be read
+	UPROPERTY(BlueprintAssignable)
+	FAsyncHashCompleted OnCompleted;
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing", meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject"))
+	static UAsyncHashAction* AsyncHash(UObject* WorldContextObject, const TArray<uint8>& BinaryData, EHashAlgorithm Algorithm = EHashAlgorithm::SHA256);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing", meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject"))
+	static UAsyncHashAction* AsyncHashString(UObject* WorldContextObject, const FString& Data, EHashAlgorithm Algorithm = EHashAlgorithm::SHA256);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing", meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject"))
+	static UAsyncHashAction* AsyncSHA256(UObject* WorldContextObject, const TArray<uint8>& BinaryData);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing", meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject"))
+	static UAsyncHashAction* AsyncHashFile(UObject* WorldContextObject, const FString& FilePath, EHashAlgorithm Algorithm = EHashAlgorithm::SHA256);
+
+	// C++ callers can hand over their buffer, the Blueprint versions above have to copy it once since the graph still owns it
+	static UAsyncHashAction* AsyncHash(UObject* WorldContextObject, TArray<uint8>&& BinaryData, EHashAlgorithm Algorithm = EHashAlgorithm::SHA256);
+	static UAsyncHashAction* AsyncHashString(UObject* WorldContextObject, FString&& Data, EHashAlgorithm Algorithm = EHashAlgorithm::SHA256);
+
+	virtual void Activate() override;
+
+private:
+
+	static UE_NODISCARD UAsyncHashAction* Create(UObject* WorldContextObject, TUniqueFunction<FString()>&& InWork);
+
+	// Runs on the thread pool, must not touch any UObject
+	TUniqueFunction<FString()> Work;
+};
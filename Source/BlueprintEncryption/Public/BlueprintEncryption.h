@@ -3,6 +3,9 @@
 #pragma once
 
 #include "Modules/ModuleManager.h"
+#include "UObject/StrongObjectPtr.h"
+
+class UJwtKeyHandle;
 
 class FBlueprintEncryptionModule : public IModuleInterface
 {
@@ -12,5 +15,19 @@ public:
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
 
+	static FBlueprintEncryptionModule& Get();
+
+	/** Keeps the key alive and makes it available under its key id, replaces any key with the same id */
+	void RegisterKey(UJwtKeyHandle* Key);
+	/**
+	 * Returns nullptr if no key is registered under the id. Game thread only: the registry is all that keeps the key alive,
+	 * so after UnregisterKey the next garbage collection can free it. Hold your own reference before passing it to other threads
+	 */
+	UJwtKeyHandle* FindKey(const FString& KeyId) const;
+	void UnregisterKey(const FString& KeyId);
+
 private:
+
+	mutable FRWLock KeysLock;
+	TMap<FString, TStrongObjectPtr<UJwtKeyHandle>> Keys;
 };
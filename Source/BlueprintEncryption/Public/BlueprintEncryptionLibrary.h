@@ -3,6 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "BlueprintEncryptionTypes.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include <string>
 
@@ -24,12 +25,38 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
 	static FString SHA256BinaryHash(const TArray<uint8>& BinaryData);
 
+	// Hashes every string independently, several messages are processed at once on CPUs with AVX2
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<FString> SHA256BatchHash(const TArray<FString>& Data);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static FString SHA512StringHash(const FString& Data);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static FString SHA512BinaryHash(const TArray<uint8>& BinaryData);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static FString SHA384StringHash(const FString& Data);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static FString SHA384BinaryHash(const TArray<uint8>& BinaryData);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static FString SHA512_256StringHash(const FString& Data);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static FString SHA512_256BinaryHash(const TArray<uint8>& BinaryData);
+
 	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
 	static FString SHA3StringHash(const FString& Data);
 
 	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
 	static FString SHA3BinaryHash(const TArray<uint8>& BinaryData);
 
+	// Hashes every string independently, several messages are processed at once on CPUs with AVX2
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<FString> SHA3BatchHash(const TArray<FString>& Data);
+
 	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
 	static FString SHA1StringHash(const FString& Data);
 
@@ -42,13 +69,126 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
 	static FString MD5BinaryHash(const TArray<uint8>& BinaryData);
 
+	// Hashes every string independently, 8 (AVX2) or 16 (AVX-512) messages are processed at once
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<FString> MD5BatchHash(const TArray<FString>& Data);
+
 	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
 	static FString KeccakStringHash(const FString& Data);
 
 	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
 	static FString CRC32StringHash(const FString& Data);
 
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static FString CRC32BinaryHash(const TArray<uint8>& BinaryData);
+
+	// Reads the file in chunks on all worker threads and merges the partial checksums, returns an empty string if the file can't be read
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static FString ParallelCRC32File(const FString& FilePath);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static FString CRC32CStringHash(const FString& Data);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static FString CRC32CBinaryHash(const TArray<uint8>& BinaryData);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static FString BLAKE3StringHash(const FString& Data);
+
+	// Large arrays are split into subtrees that are hashed on all worker threads
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static FString BLAKE3BinaryHash(const TArray<uint8>& BinaryData);
+
+	// Hashes the memory mapped file on all worker threads, returns an empty string if the file can't be read
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static FString ParallelBLAKE3File(const FString& FilePath);
+
+	// The functions below return the raw digest instead of a hex string, e.g. for storing, comparing or using it as a map key
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<uint8> SHA256StringHashBytes(const FString& Data);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<uint8> SHA256BinaryHashBytes(const TArray<uint8>& BinaryData);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<uint8> SHA512StringHashBytes(const FString& Data);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<uint8> SHA512BinaryHashBytes(const TArray<uint8>& BinaryData);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<uint8> SHA384StringHashBytes(const FString& Data);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<uint8> SHA384BinaryHashBytes(const TArray<uint8>& BinaryData);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<uint8> SHA512_256StringHashBytes(const FString& Data);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<uint8> SHA512_256BinaryHashBytes(const TArray<uint8>& BinaryData);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<uint8> SHA3StringHashBytes(const FString& Data);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<uint8> SHA3BinaryHashBytes(const TArray<uint8>& BinaryData);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<uint8> SHA1StringHashBytes(const FString& Data);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<uint8> SHA1BinaryHashBytes(const TArray<uint8>& BinaryData);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<uint8> MD5StringHashBytes(const FString& Data);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<uint8> MD5BinaryHashBytes(const TArray<uint8>& BinaryData);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<uint8> KeccakStringHashBytes(const FString& Data);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<uint8> KeccakBinaryHashBytes(const TArray<uint8>& BinaryData);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<uint8> CRC32StringHashBytes(const FString& Data);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<uint8> CRC32BinaryHashBytes(const TArray<uint8>& BinaryData);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<uint8> CRC32CStringHashBytes(const FString& Data);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<uint8> CRC32CBinaryHashBytes(const TArray<uint8>& BinaryData);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<uint8> BLAKE3StringHashBytes(const FString& Data);
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static TArray<uint8> BLAKE3BinaryHashBytes(const TArray<uint8>& BinaryData);
+
+	// Hashes the file without loading it into memory (memory mapped where supported), returns an empty string if the file can't be read
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static FString HashFile(const FString& FilePath, EHashAlgorithm Algorithm = EHashAlgorithm::SHA256);
+
+	// Hashes the data with every algorithm in the mask in a single pass over the input
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static FHashDigests ComputeDigests(const TArray<uint8>& BinaryData, UPARAM(meta = (Bitmask, BitmaskEnum = "EHashAlgorithm")) int32 AlgorithmMask);
+
+	// Reads the file once and hashes it with every algorithm in the mask, all digests are empty if the file can't be read
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static FHashDigests ComputeFileDigests(const FString& FilePath, UPARAM(meta = (Bitmask, BitmaskEnum = "EHashAlgorithm")) int32 AlgorithmMask);
+
 private:
 
 	static UE_NODISCARD std::string ConvertFromFString(const FString& InS);
+
+	static UE_NODISCARD FString ConvertDigestToString(const uint8* Digest, int32 NumBytes);
+
+	static UE_NODISCARD TArray<FString> BatchHash(const TArray<FString>& Data, int32 HashBytes,
+	                                              TFunctionRef<void(size_t, const void* const[], const size_t[], unsigned char[])> HashMany);
 };
@@ -28,4 +28,125 @@ enum class EStringEncoding : uint8
 	UTF8 UMETA(DisplayName="UTF-8"),
 	UTF16 UMETA(DisplayName="UTF-16"),
 	UTF32 UMETA(DisplayName="UTF-32"),
-};
\ No newline at end of file
+};
+
+// Can be combined into a bitmask, e.g. for UBlueprintEncryptionLibrary::ComputeDigests
+UENUM(BlueprintType, meta = (Bitflags))
+enum class EHashAlgorithm : uint8
+{
+	SHA256,
+	SHA1,
+	MD5,
+	SHA3 UMETA(DisplayName="SHA3-256"),
+	Keccak UMETA(DisplayName="Keccak-256"),
+	CRC32,
+	CRC32C,
+	SHA512 UMETA(DisplayName="SHA-512"),
+	SHA384 UMETA(DisplayName="SHA-384"),
+	SHA512_256 UMETA(DisplayName="SHA-512/256"),
+	BLAKE3,
+};
+
+// Result of hashing the same input with several algorithms, algorithms that weren't requested stay empty
+USTRUCT(BlueprintType)
+struct BLUEPRINTENCRYPTION_API FHashDigests
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Βlueprint Encryption | Hashing")
+	FString SHA256;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Βlueprint Encryption | Hashing")
+	FString SHA1;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Βlueprint Encryption | Hashing")
+	FString MD5;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Βlueprint Encryption | Hashing")
+	FString SHA3;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Βlueprint Encryption | Hashing")
+	FString Keccak;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Βlueprint Encryption | Hashing")
+	FString CRC32;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Βlueprint Encryption | Hashing")
+	FString CRC32C;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Βlueprint Encryption | Hashing")
+	FString SHA512;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Βlueprint Encryption | Hashing")
+	FString SHA384;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Βlueprint Encryption | Hashing")
+	FString SHA512_256;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Βlueprint Encryption | Hashing")
+	FString BLAKE3;
+
+	// Returns the member holding the digest of the algorithm
+	UE_NODISCARD FString& Get(EHashAlgorithm Algorithm);
+};
+
+// Claims of one token for UBlueprintJwtLibrary::EncodeTokensBatch
+USTRUCT(BlueprintType)
+struct BLUEPRINTENCRYPTION_API FJwtClaimsSet
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blueprint Encryption | JWT")
+	FString Audience;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blueprint Encryption | JWT")
+	FString Issuer;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blueprint Encryption | JWT")
+	FString Subject;
+
+	// Additional string claims, e.g. "scope"
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blueprint Encryption | JWT")
+	TMap<FString, FString> PayloadClaims;
+
+	// Lifetime in seconds, counted from the moment the batch is encoded
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blueprint Encryption | JWT")
+	int32 ExpiresAt = 3600;
+};
+
+UENUM(BlueprintType)
+enum class EJwtClaimType : uint8
+{
+	Null,
+	String,
+	Integer,
+	Number,
+	Boolean,
+	Array,
+	Object
+};
+
+// One claim of a decoded token, only the members matching Type are set
+USTRUCT(BlueprintType)
+struct BLUEPRINTENCRYPTION_API FJwtClaimValue
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Blueprint Encryption | JWT")
+	EJwtClaimType Type = EJwtClaimType::Null;
+
+	// Unescaped value of a String claim. Number and Object claims hold their json text
+	UPROPERTY(BlueprintReadOnly, Category = "Blueprint Encryption | JWT")
+	FString String;
+
+	// Value of an Integer claim, and of a Number claim that holds a whole number within int64 range (0 otherwise)
+	UPROPERTY(BlueprintReadOnly, Category = "Blueprint Encryption | JWT")
+	int64 Integer = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Blueprint Encryption | JWT")
+	bool Boolean = false;
+
+	// Elements of an Array claim, strings unescaped and everything else as json text
+	UPROPERTY(BlueprintReadOnly, Category = "Blueprint Encryption | JWT")
+	TArray<FString> Array;
+};
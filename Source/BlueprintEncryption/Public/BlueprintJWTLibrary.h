@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "BlueprintEncryptionTypes.h"
+#include "JwtKeyHandle.h"
 
 #include "Kismet/BlueprintFunctionLibrary.h"
 
@@ -36,9 +37,55 @@ public:
 	                                 EHSAlgorithm Algorithm = EHSAlgorithm::hs256,
 	                                 int32 ExpiresAt = 3600);
 
+	// Parses the RSA key once and registers it under KeyId, so tokens can be signed without parsing the PEM again.
+	// The private key is used if given (required for signing), the public key otherwise. Returns nullptr if the key can't be parsed
+	UFUNCTION(BlueprintCallable, Category = "Blueprint Encryption | JWT")
+	static URSAKeyHandle* RegisterRSAKey(const FString& KeyId, FString PublicKey = TEXT(""), FString PublicKeyPassword = TEXT(""),
+	                                     FString PrivateKey = TEXT(""), FString PrivateKeyPassword = TEXT(""),
+	                                     ERSAlgorithm Algorithm = ERSAlgorithm::rs256);
+
+	// Registers an HMAC secret under KeyId, signing with the returned handle skips the per token key setup
+	UFUNCTION(BlueprintCallable, Category = "Blueprint Encryption | JWT")
+	static UHMACKeyHandle* RegisterHMACKey(const FString& KeyId, FString Secret = TEXT(""), EHSAlgorithm Algorithm = EHSAlgorithm::hs256);
+
+	// Returns the key registered under KeyId, or nullptr. Unregistering the key lets it be garbage collected
+	UFUNCTION(BlueprintCallable, Category = "Blueprint Encryption | JWT")
+	static UJwtKeyHandle* FindKey(const FString& KeyId);
+
+	UFUNCTION(BlueprintCallable, Category = "Blueprint Encryption | JWT")
+	static void UnregisterKey(const FString& KeyId);
+
+	// Encodes a JWT signed with a previously registered key
+	UFUNCTION(BlueprintCallable, Category = "Blueprint Encryption | JWT", meta = (DisplayName = "Encode JWT using key handle"))
+	static FString K2_EncodeToken_Key(FString Audience, FString Issuer, FString Subject, FString PayloadClaimType = TEXT("scope"),
+	                                  FString PayloadClaim = TEXT(""), UJwtKeyHandle* Key = nullptr, int32 ExpiresAt = 3600);
+
+	// Encodes one token per claims set. The header is serialized once and buffers are reused across tokens,
+	// RSA signatures are computed on all worker threads. Every token is "ERROR" if the key is invalid
+	UFUNCTION(BlueprintCallable, Category = "Blueprint Encryption | JWT")
+	static TArray<FString> EncodeTokensBatch(const TArray<FJwtClaimsSet>& Claims, UJwtKeyHandle* Key);
+
+	// Encodes a JWT whose payload claims are the properties of Struct, named like with Serialize Struct To String.
+	// iat and exp are added unless the struct has properties of that name. Returns "ERROR" if the key is invalid
+	UFUNCTION(BlueprintCallable, CustomThunk, Category = "Blueprint Encryption | JWT", meta = (CustomStructureParam = "Struct", AutoCreateRefTerm = "Struct"))
+	static FString EncodeStructAsToken(const int32& Struct, UJwtKeyHandle* Key, int32 ExpiresAt = 3600);
+	DECLARE_FUNCTION(execEncodeStructAsToken);
+
+	// Same as EncodeStructAsToken, for C++ callers
+	static UE_NODISCARD FString EncodeStructDataAsToken(const UScriptStruct* Struct, const void* StructData, const UJwtKeyHandle* Key,
+	                                                    int32 ExpiresAt = 3600);
+
+	// Every payload claim as json text. Numbers keep the text they have in the token, the claims are added in token order
 	UFUNCTION(BlueprintCallable, Category = "Blueprint Encryption | JWT", meta = (DisplayName = "Decode JWT"))
 	static TMap<FString, FString> K2_DecodeToken(const FString& JWT);
 
+	// Same as Decode JWT, but every claim keeps its type instead of being turned into json, so strings come without quotes
+	UFUNCTION(BlueprintCallable, Category = "Blueprint Encryption | JWT", meta = (DisplayName = "Decode JWT Typed"))
+	static TMap<FString, FJwtClaimValue> K2_DecodeTokenTyped(const FString& JWT);
+
+	// Adds every claim of the parsed payload to OutClaims
+	static void ReadClaims(const jwt::claims_document& Payload, TMap<FString, FJwtClaimValue>& OutClaims);
+
 	UFUNCTION(BlueprintCallable, BlueprintInternalUseOnly, CustomThunk, Category = "Blueprint Encryption | Utils", meta = (CustomStructureParam = "Struct", AutoCreateRefTerm = "Struct"))
 	static bool SerializeStructToString(const int32& Struct, FString& OutJsonString);
 	DECLARE_FUNCTION(execSerializeStructToString);
@@ -0,0 +1,138 @@
+// Copyright 2022 Chris Ringenberg https://www.ringenberg.dev/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BlueprintEncryptionTypes.h"
+
+#include "UObject/Object.h"
+
+#include <string>
+#include <string_view>
+
+#include "jwt.h"
+#include "JwtKeyHandle.generated.h"
+
+/**
+ * A JWT key that is parsed once and then reused for any number of tokens
+ */
+UCLASS(Abstract, BlueprintType)
+class BLUEPRINTENCRYPTION_API UJwtKeyHandle : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	// Name the key is registered under, see UBlueprintJwtLibrary::FindKey
+	UFUNCTION(BlueprintPure, Category = "Blueprint Encryption | JWT")
+	FString GetKeyId() const { return KeyId; }
+
+	// False if the key couldn't be parsed
+	UFUNCTION(BlueprintPure, Category = "Blueprint Encryption | JWT")
+	virtual bool IsValidKey() const PURE_VIRTUAL(UJwtKeyHandle::IsValidKey, return false;);
+
+	// Algorithm written into the token header, e.g. "RS256"
+	virtual std::string GetAlgorithmName() const PURE_VIRTUAL(UJwtKeyHandle::GetAlgorithmName, return {};);
+
+	// Raw signature of Data, safe to call from several threads at once
+	virtual std::string Sign(const std::string& Data) const PURE_VIRTUAL(UJwtKeyHandle::Sign, return {};);
+
+	// Same as Sign(), but writes into OutSignature so a batch of tokens can reuse one buffer
+	virtual void Sign(const std::string& Data, std::string& OutSignature) const { OutSignature = Sign(Data); }
+
+	// True if Signature is a valid raw signature of Data, safe to call from several threads at once
+	virtual bool Verify(std::string_view Data, std::string_view Signature) const PURE_VIRTUAL(UJwtKeyHandle::Verify, return false;);
+
+	// True if signing is expensive enough to be worth spreading a batch of tokens across threads
+	virtual bool IsAsymmetric() const { return false; }
+
+protected:
+
+	UPROPERTY()
+	FString KeyId;
+};
+
+/**
+ * RSA key for RS256 / RS384 / RS512, the PEM is parsed (and decrypted) only once
+ */
+UCLASS(BlueprintType)
+class BLUEPRINTENCRYPTION_API URSAKeyHandle final : public UJwtKeyHandle
+{
+	GENERATED_BODY()
+
+public:
+
+	// Parses the private key if given, the public key otherwise. Returns an invalid handle if parsing fails
+	static UE_NODISCARD URSAKeyHandle* Create(const FString& InKeyId, const std::string& PublicKey, const std::string& PrivateKey,
+	                                          const std::string& PublicKeyPassword, const std::string& PrivateKeyPassword,
+	                                          ERSAlgorithm InAlgorithm);
+
+	UFUNCTION(BlueprintPure, Category = "Blueprint Encryption | JWT")
+	ERSAlgorithm GetAlgorithm() const { return AlgorithmType; }
+
+	virtual bool IsValidKey() const override;
+
+	virtual std::string GetAlgorithmName() const override;
+
+	virtual std::string Sign(const std::string& Data) const override;
+
+	virtual void Sign(const std::string& Data, std::string& OutSignature) const override;
+
+	virtual bool Verify(std::string_view Data, std::string_view Signature) const override;
+
+	virtual bool IsAsymmetric() const override { return true; }
+
+private:
+
+	UPROPERTY()
+	ERSAlgorithm AlgorithmType;
+
+	// Held by value, jwt::algorithm::rsa has no virtual destructor so it can't own an rs256 through a base pointer
+	TOptional<jwt::algorithm::rsa> Algorithm;
+};
+
+/**
+ * HMAC secret for HS256 / HS384 / HS512, the keyed inner and outer hash states are computed only once
+ */
+UCLASS(BlueprintType)
+class BLUEPRINTENCRYPTION_API UHMACKeyHandle final : public UJwtKeyHandle
+{
+	GENERATED_BODY()
+
+public:
+
+	static UE_NODISCARD UHMACKeyHandle* Create(const FString& InKeyId, const std::string& Secret, EHSAlgorithm InAlgorithm);
+
+	UFUNCTION(BlueprintPure, Category = "Blueprint Encryption | JWT")
+	EHSAlgorithm GetAlgorithm() const { return AlgorithmType; }
+
+	virtual bool IsValidKey() const override;
+
+	virtual std::string GetAlgorithmName() const override;
+
+	virtual std::string Sign(const std::string& Data) const override;
+
+	virtual void Sign(const std::string& Data, std::string& OutSignature) const override;
+
+	virtual bool Verify(std::string_view Data, std::string_view Signature) const override;
+
+private:
+
+	UPROPERTY()
+	EHSAlgorithm AlgorithmType;
+
+	// Held by value for the same reason as URSAKeyHandle::Algorithm
+	TOptional<jwt::algorithm::hmacsha> Algorithm;
+};
+
+/**
+ * Adapter so a key handle can be passed to jwt::builder::sign() like any jwt::algorithm
+ */
+struct FJwtKeyHandleAlgorithm
+{
+	const UJwtKeyHandle& Key;
+
+	std::string name() const { return Key.GetAlgorithmName(); }
+
+	std::string sign(const std::string& Data) const { return Key.Sign(Data); }
+};
@@ -0,0 +1,89 @@
+// Copyright 2022 Chris Ringenberg https://www.ringenberg.dev/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BlueprintEncryptionTypes.h"
+
+#include "UObject/Object.h"
+
+#include <string>
+#include <string_view>
+
+#include "jwt.h"
+#include "JwtVerifier.generated.h"
+
+class UJwtKeyHandle;
+class FVerifiedTokenCache;
+
+/**
+ * Checks signature, lifetime, issuer and audience of tokens. Configured once and then reused for any number of tokens,
+ * the keys are only parsed when their handles are created
+ */
+UCLASS(BlueprintType)
+class BLUEPRINTENCRYPTION_API UJwtVerifier final : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual ~UJwtVerifier() override;
+
+	// Only tokens signed with one of the keys are accepted, which also limits the allowed algorithms to those of the keys.
+	// Issuer and Audience aren't checked if empty. Leeway is the clock skew in seconds tolerated for exp, nbf and iat.
+	// If CacheSize is positive, up to that many verified tokens are remembered until they expire, so a token that is sent
+	// again is accepted without checking its signature a second time
+	UFUNCTION(BlueprintCallable, Category = "Blueprint Encryption | JWT")
+	static UJwtVerifier* CreateJwtVerifier(const TArray<UJwtKeyHandle*>& Keys, const FString& Issuer, const FString& Audience,
+	                                       int32 LeewaySeconds = 0, int32 CacheSize = 0);
+
+	// Returns true if the token is valid, Claims then holds its payload claims as json (same as Decode JWT)
+	UFUNCTION(BlueprintCallable, Category = "Blueprint Encryption | JWT")
+	bool Verify(const FString& Token, TMap<FString, FString>& Claims) const;
+
+	// Same as Verify, but the claims keep their types like with Decode JWT Typed
+	UFUNCTION(BlueprintCallable, Category = "Blueprint Encryption | JWT")
+	bool VerifyTyped(const FString& Token, TMap<FString, FJwtClaimValue>& Claims) const;
+
+	// Verifies all tokens, RSA signatures are checked on all worker threads
+	UFUNCTION(BlueprintCallable, Category = "Blueprint Encryption | JWT")
+	TArray<bool> VerifyBatch(const TArray<FString>& Tokens) const;
+
+	// Forgets all cached tokens, e.g. after a key was compromised
+	UFUNCTION(BlueprintCallable, Category = "Blueprint Encryption | JWT")
+	void ClearCache();
+
+	// Same as Verify, for C++ callers that already have the UTF-8 token. OutPayload may be nullptr, safe to call from any thread
+	UE_NODISCARD bool VerifyToken(std::string_view Token, jwt::claims_document* OutPayload = nullptr) const;
+
+private:
+
+	struct FKeyEntry
+	{
+		std::string Algorithm;
+		std::string KeyId;
+		const UJwtKeyHandle* Key;
+	};
+
+	// Tries the key named by KeyId (the "kid" header) if there is one, all keys of the algorithm otherwise
+	UE_NODISCARD bool VerifySignature(std::string_view Algorithm, const std::string_view* KeyId, std::string_view Data,
+	                                  std::string_view Signature) const;
+
+	// OutExpiresAt is the exp claim, or MAX_int64 if the token doesn't expire
+	UE_NODISCARD bool VerifyClaims(const jwt::claims_document& Payload, int64 Now, int64& OutExpiresAt) const;
+
+	UPROPERTY()
+	TArray<UJwtKeyHandle*> Keys;
+
+	TArray<FKeyEntry> KeyEntries;
+
+	std::string Issuer;
+
+	std::string Audience;
+
+	int64 Leeway = 0;
+
+	bool bHasAsymmetricKey = false;
+
+	TUniquePtr<FVerifiedTokenCache> Cache;
+};
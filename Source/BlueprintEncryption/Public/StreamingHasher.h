@@ -0,0 +1,61 @@
+// Copyright 2022 Chris Ringenberg https://www.ringenberg.dev/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BlueprintEncryptionTypes.h"
+
+#include "UObject/Object.h"
+
+#include "StreamingHasher.generated.h"
+
+class IHashAlgorithm;
+
+/**
+ * Hashes data incrementally, so large inputs (file reads, socket data, ...) never have to be held in memory at once
+ */
+UCLASS(BlueprintType)
+class BLUEPRINTENCRYPTION_API UStreamingHasher final : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual ~UStreamingHasher() override;
+
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	static UStreamingHasher* CreateStreamingHasher(EHashAlgorithm Algorithm);
+
+	// Adds the bytes to the hash
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	void Update(const TArray<uint8>& BinaryData);
+
+	// Adds the UTF-8 representation of the string to the hash
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	void UpdateString(const FString& Data);
+
+	// Returns the hash of everything added since the last reset, more data can still be added afterwards
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	FString Finalize();
+
+	// Same as Finalize, but returns the raw digest
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	TArray<uint8> FinalizeBytes();
+
+	// Discards all added data
+	UFUNCTION(BlueprintCallable, Category = "Βlueprint Encryption | Hashing")
+	void Reset();
+
+	UFUNCTION(BlueprintPure, Category = "Βlueprint Encryption | Hashing")
+	EHashAlgorithm GetAlgorithm() const { return Algorithm; }
+
+	// Adds raw bytes, for C++ callers
+	void UpdateBytes(const void* Data, size_t NumBytes);
+
+private:
+
+	UPROPERTY()
+	EHashAlgorithm Algorithm;
+
+	TUniquePtr<IHashAlgorithm> Hash;
+};
@@ -0,0 +1,826 @@
+// //////////////////////////////////////////////////////////
+// blake3.cpp
+//
+
+#include "blake3.h"
+#include "cpufeatures.h"
+
+#include <cstring>
+
+#ifdef HASH_LIBRARY_X86
+#include <immintrin.h>
+#endif
+
+
+namespace
+{
+  /// same initial values as SHA256
+  const uint32_t InitialHash[8] =
+  {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+  };
+
+  /// domain separation flags
+  enum
+  {
+    ChunkStart = 1,
+    ChunkEnd   = 2,
+    Parent     = 4,
+    Root       = 8
+  };
+
+  /// message words used by each of the seven rounds
+  const uint8_t MessageSchedule[7][16] =
+  {
+    {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+    {  2,  6,  3, 10,  7,  0,  4, 13,  1, 11, 12,  5,  9, 14, 15,  8 },
+    {  3,  4, 10, 12, 13,  2,  7, 14,  6,  5,  9,  0, 11, 15,  8,  1 },
+    { 10,  7, 12,  9, 14,  3, 13, 15,  4,  0, 11,  2,  5,  8,  1,  6 },
+    { 12, 13,  9, 11, 15, 10, 14,  8,  7,  2,  5,  3,  0,  1,  6,  4 },
+    {  9, 14, 11,  5,  8, 12, 15,  1, 13,  3,  0, 10,  2,  6,  4,  7 },
+    { 11, 15,  5,  0,  1,  9,  8,  6, 14, 10,  2, 12,  3,  4,  7, 13 }
+  };
+
+  /// subtrees up to this size are hashed level by level in a buffer on the stack, larger ones are split
+  const size_t MaxBufferedChunks = 64;
+
+  inline uint32_t rotate(uint32_t a, uint32_t c)
+  {
+    return (a >> c) | (a << (32 - c));
+  }
+
+  /// BLAKE3 is little endian
+  inline uint32_t load32(const uint8_t* data)
+  {
+    return  (uint32_t) data[0]        | ((uint32_t) data[1] <<  8) |
+           ((uint32_t) data[2] << 16) | ((uint32_t) data[3] << 24);
+  }
+
+  inline void store32(uint8_t* data, uint32_t x)
+  {
+    data[0] = (uint8_t) x;
+    data[1] = (uint8_t)(x >>  8);
+    data[2] = (uint8_t)(x >> 16);
+    data[3] = (uint8_t)(x >> 24);
+  }
+
+  /// mix function
+  inline void g(uint32_t state[16], int a, int b, int c, int d, uint32_t x, uint32_t y)
+  {
+    state[a] += state[b] + x; state[d] = rotate(state[d] ^ state[a], 16);
+    state[c] += state[d];     state[b] = rotate(state[b] ^ state[c], 12);
+    state[a] += state[b] + y; state[d] = rotate(state[d] ^ state[a],  8);
+    state[c] += state[d];     state[b] = rotate(state[b] ^ state[c],  7);
+  }
+
+  /// compress one block, returns the first half of the output (the chaining value)
+  void compress(const uint32_t chainingValue[8], const uint8_t block[64], uint64_t counter, uint32_t blockSize, uint32_t flags,
+                uint32_t result[8])
+  {
+    uint32_t words[16];
+    for (int i = 0; i < 16; i++)
+      words[i] = load32(block + 4 * i);
+
+    uint32_t state[16] =
+    {
+      chainingValue[0], chainingValue[1], chainingValue[2], chainingValue[3],
+      chainingValue[4], chainingValue[5], chainingValue[6], chainingValue[7],
+      InitialHash[0], InitialHash[1], InitialHash[2], InitialHash[3],
+      (uint32_t) counter, (uint32_t)(counter >> 32), blockSize, flags
+    };
+
+    for (int round = 0; round < 7; round++)
+    {
+      const uint8_t* schedule = MessageSchedule[round];
+      // columns
+      g(state, 0, 4,  8, 12, words[schedule[ 0]], words[schedule[ 1]]);
+      g(state, 1, 5,  9, 13, words[schedule[ 2]], words[schedule[ 3]]);
+      g(state, 2, 6, 10, 14, words[schedule[ 4]], words[schedule[ 5]]);
+      g(state, 3, 7, 11, 15, words[schedule[ 6]], words[schedule[ 7]]);
+      // diagonals
+      g(state, 0, 5, 10, 15, words[schedule[ 8]], words[schedule[ 9]]);
+      g(state, 1, 6, 11, 12, words[schedule[10]], words[schedule[11]]);
+      g(state, 2, 7,  8, 13, words[schedule[12]], words[schedule[13]]);
+      g(state, 3, 4,  9, 14, words[schedule[14]], words[schedule[15]]);
+    }
+
+    for (int i = 0; i < 8; i++)
+      result[i] = state[i] ^ state[i + 8];
+  }
+
+  /// chaining value of a parent node, the block is the concatenation of both children
+  void compressParent(const uint32_t left[8], const uint32_t right[8], uint32_t flags, uint32_t result[8])
+  {
+    uint8_t block[64];
+    for (int i = 0; i < 8; i++)
+    {
+      store32(block +      4 * i, left [i]);
+      store32(block + 32 + 4 * i, right[i]);
+    }
+    compress(InitialHash, block, 0, 64, flags | Parent, result);
+  }
+
+  /// hash numBlocks blocks of a single input, the first block gets flagsStart, the last block flagsEnd
+  void hashOne(const uint8_t* input, size_t numBlocks, uint64_t counter, uint32_t flags, uint32_t flagsStart, uint32_t flagsEnd,
+               uint8_t* out)
+  {
+    uint32_t chainingValue[8];
+    for (int i = 0; i < 8; i++)
+      chainingValue[i] = InitialHash[i];
+
+    for (size_t block = 0; block < numBlocks; block++, input += 64)
+    {
+      uint32_t blockFlags = flags | (block == 0 ? flagsStart : 0) | (block + 1 == numBlocks ? flagsEnd : 0);
+      compress(chainingValue, input, counter, 64, blockFlags, chainingValue);
+    }
+
+    for (int i = 0; i < 8; i++)
+      store32(out + 4 * i, chainingValue[i]);
+  }
+
+#ifdef HASH_LIBRARY_X86
+  // the SIMD versions process one input per lane, state and message words are interleaved as [word][lane]
+
+  /// transpose 4x4 words
+  HASH_TARGET("sse4.1")
+  inline void transpose4(__m128i rows[4])
+  {
+    __m128i t0 = _mm_unpacklo_epi32(rows[0], rows[1]);
+    __m128i t1 = _mm_unpackhi_epi32(rows[0], rows[1]);
+    __m128i t2 = _mm_unpacklo_epi32(rows[2], rows[3]);
+    __m128i t3 = _mm_unpackhi_epi32(rows[2], rows[3]);
+
+    rows[0] = _mm_unpacklo_epi64(t0, t2);
+    rows[1] = _mm_unpackhi_epi64(t0, t2);
+    rows[2] = _mm_unpacklo_epi64(t1, t3);
+    rows[3] = _mm_unpackhi_epi64(t1, t3);
+  }
+
+  HASH_TARGET("sse4.1")
+  inline void g4(__m128i v[16], int a, int b, int c, int d, __m128i x, __m128i y)
+  {
+    const __m128i rotate16 = _mm_set_epi8(13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2);
+    const __m128i rotate8  = _mm_set_epi8(12, 15, 14, 13, 8, 11, 10, 9, 4, 7, 6, 5, 0, 3, 2, 1);
+
+    v[a] = _mm_add_epi32(_mm_add_epi32(v[a], v[b]), x);
+    v[d] = _mm_shuffle_epi8(_mm_xor_si128(v[d], v[a]), rotate16);
+    v[c] = _mm_add_epi32(v[c], v[d]);
+    v[b] = _mm_xor_si128(v[b], v[c]);
+    v[b] = _mm_or_si128(_mm_srli_epi32(v[b], 12), _mm_slli_epi32(v[b], 32 - 12));
+    v[a] = _mm_add_epi32(_mm_add_epi32(v[a], v[b]), y);
+    v[d] = _mm_shuffle_epi8(_mm_xor_si128(v[d], v[a]), rotate8);
+    v[c] = _mm_add_epi32(v[c], v[d]);
+    v[b] = _mm_xor_si128(v[b], v[c]);
+    v[b] = _mm_or_si128(_mm_srli_epi32(v[b], 7), _mm_slli_epi32(v[b], 32 - 7));
+  }
+
+  HASH_TARGET("sse4.1")
+  inline void round4(__m128i v[16], const __m128i m[16], int round)
+  {
+    const uint8_t* schedule = MessageSchedule[round];
+    g4(v, 0, 4,  8, 12, m[schedule[ 0]], m[schedule[ 1]]);
+    g4(v, 1, 5,  9, 13, m[schedule[ 2]], m[schedule[ 3]]);
+    g4(v, 2, 6, 10, 14, m[schedule[ 4]], m[schedule[ 5]]);
+    g4(v, 3, 7, 11, 15, m[schedule[ 6]], m[schedule[ 7]]);
+    g4(v, 0, 5, 10, 15, m[schedule[ 8]], m[schedule[ 9]]);
+    g4(v, 1, 6, 11, 12, m[schedule[10]], m[schedule[11]]);
+    g4(v, 2, 7,  8, 13, m[schedule[12]], m[schedule[13]]);
+    g4(v, 3, 4,  9, 14, m[schedule[14]], m[schedule[15]]);
+  }
+
+  /// hash four inputs of numBlocks blocks each
+  HASH_TARGET("sse4.1")
+  void hash4Sse41(const uint8_t* const inputs[4], size_t numBlocks, uint64_t counter, bool incrementCounter,
+                  uint32_t flags, uint32_t flagsStart, uint32_t flagsEnd, uint8_t* out)
+  {
+    __m128i h[8];
+    for (int i = 0; i < 8; i++)
+      h[i] = _mm_set1_epi32((int) InitialHash[i]);
+
+    uint64_t step = incrementCounter ? 1 : 0;
+    __m128i counterLow  = _mm_set_epi32((int)(counter + 3 * step), (int)(counter + 2 * step),
+                                        (int)(counter + step), (int) counter);
+    __m128i counterHigh = _mm_set_epi32((int)((counter + 3 * step) >> 32), (int)((counter + 2 * step) >> 32),
+                                        (int)((counter + step) >> 32), (int)(counter >> 32));
+
+    for (size_t block = 0; block < numBlocks; block++)
+    {
+      __m128i m[16];
+      for (int quarter = 0; quarter < 4; quarter++)
+      {
+        for (int lane = 0; lane < 4; lane++)
+          m[4 * quarter + lane] = _mm_loadu_si128((const __m128i*)(inputs[lane] + 64 * block + 16 * quarter));
+        transpose4(m + 4 * quarter);
+      }
+
+      uint32_t blockFlags = flags | (block == 0 ? flagsStart : 0) | (block + 1 == numBlocks ? flagsEnd : 0);
+      __m128i v[16] =
+      {
+        h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7],
+        _mm_set1_epi32((int) InitialHash[0]), _mm_set1_epi32((int) InitialHash[1]),
+        _mm_set1_epi32((int) InitialHash[2]), _mm_set1_epi32((int) InitialHash[3]),
+        counterLow, counterHigh, _mm_set1_epi32(64), _mm_set1_epi32((int) blockFlags)
+      };
+
+      round4(v, m, 0);
+      round4(v, m, 1);
+      round4(v, m, 2);
+      round4(v, m, 3);
+      round4(v, m, 4);
+      round4(v, m, 5);
+      round4(v, m, 6);
+
+      for (int i = 0; i < 8; i++)
+        h[i] = _mm_xor_si128(v[i], v[i + 8]);
+    }
+
+    // back to one chaining value per input
+    transpose4(h);
+    transpose4(h + 4);
+    for (int lane = 0; lane < 4; lane++)
+    {
+      _mm_storeu_si128((__m128i*)(out + 32 * lane),      h[lane]);
+      _mm_storeu_si128((__m128i*)(out + 32 * lane + 16), h[lane + 4]);
+    }
+  }
+
+  /// transpose 8x8 words
+  HASH_TARGET("avx2")
+  inline void transpose8(__m256i rows[8])
+  {
+    __m256i t0 = _mm256_unpacklo_epi32(rows[0], rows[1]);
+    __m256i t1 = _mm256_unpackhi_epi32(rows[0], rows[1]);
+    __m256i t2 = _mm256_unpacklo_epi32(rows[2], rows[3]);
+    __m256i t3 = _mm256_unpackhi_epi32(rows[2], rows[3]);
+    __m256i t4 = _mm256_unpacklo_epi32(rows[4], rows[5]);
+    __m256i t5 = _mm256_unpackhi_epi32(rows[4], rows[5]);
+    __m256i t6 = _mm256_unpacklo_epi32(rows[6], rows[7]);
+    __m256i t7 = _mm256_unpackhi_epi32(rows[6], rows[7]);
+
+    __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+    __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+    __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+    __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+    __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+    __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+    __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+    __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+    rows[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+    rows[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+    rows[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+    rows[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+    rows[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+    rows[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+    rows[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+    rows[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+  }
+
+  HASH_TARGET("avx2")
+  inline void g8(__m256i v[16], int a, int b, int c, int d, __m256i x, __m256i y)
+  {
+    const __m256i rotate16 = _mm256_set_epi8(13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2,
+                                             13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2);
+    const __m256i rotate8  = _mm256_set_epi8(12, 15, 14, 13, 8, 11, 10, 9, 4, 7, 6, 5, 0, 3, 2, 1,
+                                             12, 15, 14, 13, 8, 11, 10, 9, 4, 7, 6, 5, 0, 3, 2, 1);
+
+    v[a] = _mm256_add_epi32(_mm256_add_epi32(v[a], v[b]), x);
+    v[d] = _mm256_shuffle_epi8(_mm256_xor_si256(v[d], v[a]), rotate16);
+    v[c] = _mm256_add_epi32(v[c], v[d]);
+    v[b] = _mm256_xor_si256(v[b], v[c]);
+    v[b] = _mm256_or_si256(_mm256_srli_epi32(v[b], 12), _mm256_slli_epi32(v[b], 32 - 12));
+    v[a] = _mm256_add_epi32(_mm256_add_epi32(v[a], v[b]), y);
+    v[d] = _mm256_shuffle_epi8(_mm256_xor_si256(v[d], v[a]), rotate8);
+    v[c] = _mm256_add_epi32(v[c], v[d]);
+    v[b] = _mm256_xor_si256(v[b], v[c]);
+    v[b] = _mm256_or_si256(_mm256_srli_epi32(v[b], 7), _mm256_slli_epi32(v[b], 32 - 7));
+  }
+
+  HASH_TARGET("avx2")
+  inline void round8(__m256i v[16], const __m256i m[16], int round)
+  {
+    const uint8_t* schedule = MessageSchedule[round];
+    g8(v, 0, 4,  8, 12, m[schedule[ 0]], m[schedule[ 1]]);
+    g8(v, 1, 5,  9, 13, m[schedule[ 2]], m[schedule[ 3]]);
+    g8(v, 2, 6, 10, 14, m[schedule[ 4]], m[schedule[ 5]]);
+    g8(v, 3, 7, 11, 15, m[schedule[ 6]], m[schedule[ 7]]);
+    g8(v, 0, 5, 10, 15, m[schedule[ 8]], m[schedule[ 9]]);
+    g8(v, 1, 6, 11, 12, m[schedule[10]], m[schedule[11]]);
+    g8(v, 2, 7,  8, 13, m[schedule[12]], m[schedule[13]]);
+    g8(v, 3, 4,  9, 14, m[schedule[14]], m[schedule[15]]);
+  }
+
+  /// hash eight inputs of numBlocks blocks each
+  HASH_TARGET("avx2")
+  void hash8Avx2(const uint8_t* const inputs[8], size_t numBlocks, uint64_t counter, bool incrementCounter,
+                 uint32_t flags, uint32_t flagsStart, uint32_t flagsEnd, uint8_t* out)
+  {
+    __m256i h[8];
+    for (int i = 0; i < 8; i++)
+      h[i] = _mm256_set1_epi32((int) InitialHash[i]);
+
+    uint32_t counters[2][8];
+    for (int lane = 0; lane < 8; lane++)
+    {
+      uint64_t laneCounter = counter + (incrementCounter ? lane : 0);
+      counters[0][lane] = (uint32_t) laneCounter;
+      counters[1][lane] = (uint32_t)(laneCounter >> 32);
+    }
+    __m256i counterLow  = _mm256_loadu_si256((const __m256i*) counters[0]);
+    __m256i counterHigh = _mm256_loadu_si256((const __m256i*) counters[1]);
+
+    for (size_t block = 0; block < numBlocks; block++)
+    {
+      __m256i m[16];
+      for (int half = 0; half < 2; half++)
+      {
+        for (int lane = 0; lane < 8; lane++)
+          m[8 * half + lane] = _mm256_loadu_si256((const __m256i*)(inputs[lane] + 64 * block + 32 * half));
+        transpose8(m + 8 * half);
+      }
+
+      uint32_t blockFlags = flags | (block == 0 ? flagsStart : 0) | (block + 1 == numBlocks ? flagsEnd : 0);
+      __m256i v[16] =
+      {
+        h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7],
+        _mm256_set1_epi32((int) InitialHash[0]), _mm256_set1_epi32((int) InitialHash[1]),
+        _mm256_set1_epi32((int) InitialHash[2]), _mm256_set1_epi32((int) InitialHash[3]),
+        counterLow, counterHigh, _mm256_set1_epi32(64), _mm256_set1_epi32((int) blockFlags)
+      };
+
+      round8(v, m, 0);
+      round8(v, m, 1);
+      round8(v, m, 2);
+      round8(v, m, 3);
+      round8(v, m, 4);
+      round8(v, m, 5);
+      round8(v, m, 6);
+
+      for (int i = 0; i < 8; i++)
+        h[i] = _mm256_xor_si256(v[i], v[i + 8]);
+    }
+
+    // back to one chaining value per input
+    transpose8(h);
+    for (int lane = 0; lane < 8; lane++)
+      _mm256_storeu_si256((__m256i*)(out + 32 * lane), h[lane]);
+  }
+
+  /// transpose 16x16 words
+  HASH_TARGET("avx512f")
+  inline void transpose16(__m512i rows[16])
+  {
+    // 4x4 words within each 128 bit lane
+    __m512i t[16];
+    for (int i = 0; i < 16; i += 2)
+    {
+      t[i]     = _mm512_unpacklo_epi32(rows[i], rows[i + 1]);
+      t[i + 1] = _mm512_unpackhi_epi32(rows[i], rows[i + 1]);
+    }
+    __m512i u[16];
+    for (int i = 0; i < 16; i += 4)
+    {
+      u[i]     = _mm512_unpacklo_epi64(t[i],     t[i + 2]);
+      u[i + 1] = _mm512_unpackhi_epi64(t[i],     t[i + 2]);
+      u[i + 2] = _mm512_unpacklo_epi64(t[i + 1], t[i + 3]);
+      u[i + 3] = _mm512_unpackhi_epi64(t[i + 1], t[i + 3]);
+    }
+
+    // 4x4 of the 128 bit lanes, u[4 * i + k] holds word 4 * lane + k of rows 4 * i ... 4 * i + 3
+    for (int k = 0; k < 4; k++)
+    {
+      __m512i c0 = _mm512_shuffle_i32x4(u[k],     u[4 + k],  0x44);
+      __m512i c1 = _mm512_shuffle_i32x4(u[k],     u[4 + k],  0xEE);
+      __m512i c2 = _mm512_shuffle_i32x4(u[8 + k], u[12 + k], 0x44);
+      __m512i c3 = _mm512_shuffle_i32x4(u[8 + k], u[12 + k], 0xEE);
+
+      rows[k]      = _mm512_shuffle_i32x4(c0, c2, 0x88);
+      rows[4 + k]  = _mm512_shuffle_i32x4(c0, c2, 0xDD);
+      rows[8 + k]  = _mm512_shuffle_i32x4(c1, c3, 0x88);
+      rows[12 + k] = _mm512_shuffle_i32x4(c1, c3, 0xDD);
+    }
+  }
+
+  HASH_TARGET("avx512f")
+  inline void g16(__m512i v[16], int a, int b, int c, int d, __m512i x, __m512i y)
+  {
+    v[a] = _mm512_add_epi32(_mm512_add_epi32(v[a], v[b]), x);
+    v[d] = _mm512_ror_epi32(_mm512_xor_si512(v[d], v[a]), 16);
+    v[c] = _mm512_add_epi32(v[c], v[d]);
+    v[b] = _mm512_ror_epi32(_mm512_xor_si512(v[b], v[c]), 12);
+    v[a] = _mm512_add_epi32(_mm512_add_epi32(v[a], v[b]), y);
+    v[d] = _mm512_ror_epi32(_mm512_xor_si512(v[d], v[a]), 8);
+    v[c] = _mm512_add_epi32(v[c], v[d]);
+    v[b] = _mm512_ror_epi32(_mm512_xor_si512(v[b], v[c]), 7);
+  }
+
+  HASH_TARGET("avx512f")
+  inline void round16(__m512i v[16], const __m512i m[16], int round)
+  {
+    const uint8_t* schedule = MessageSchedule[round];
+    g16(v, 0, 4,  8, 12, m[schedule[ 0]], m[schedule[ 1]]);
+    g16(v, 1, 5,  9, 13, m[schedule[ 2]], m[schedule[ 3]]);
+    g16(v, 2, 6, 10, 14, m[schedule[ 4]], m[schedule[ 5]]);
+    g16(v, 3, 7, 11, 15, m[schedule[ 6]], m[schedule[ 7]]);
+    g16(v, 0, 5, 10, 15, m[schedule[ 8]], m[schedule[ 9]]);
+    g16(v, 1, 6, 11, 12, m[schedule[10]], m[schedule[11]]);
+    g16(v, 2, 7,  8, 13, m[schedule[12]], m[schedule[13]]);
+    g16(v, 3, 4,  9, 14, m[schedule[14]], m[schedule[15]]);
+  }
+
+  /// hash sixteen inputs of numBlocks blocks each
+  HASH_TARGET("avx512f")
+  void hash16Avx512(const uint8_t* const inputs[16], size_t numBlocks, uint64_t counter, bool incrementCounter,
+                    uint32_t flags, uint32_t flagsStart, uint32_t flagsEnd, uint8_t* out)
+  {
+    __m512i h[16];
+    for (int i = 0; i < 8; i++)
+      h[i] = _mm512_set1_epi32((int) InitialHash[i]);
+
+    uint32_t counters[2][16];
+    for (int lane = 0; lane < 16; lane++)
+    {
+      uint64_t laneCounter = counter + (incrementCounter ? lane : 0);
+      counters[0][lane] = (uint32_t) laneCounter;
+      counters[1][lane] = (uint32_t)(laneCounter >> 32);
+    }
+    __m512i counterLow  = _mm512_loadu_si512(counters[0]);
+    __m512i counterHigh = _mm512_loadu_si512(counters[1]);
+
+    for (size_t block = 0; block < numBlocks; block++)
+    {
+      __m512i m[16];
+      for (int lane = 0; lane < 16; lane++)
+        m[lane] = _mm512_loadu_si512(inputs[lane] + 64 * block);
+      transpose16(m);
+
+      uint32_t blockFlags = flags | (block == 0 ? flagsStart : 0) | (block + 1 == numBlocks ? flagsEnd : 0);
+      __m512i v[16] =
+      {
+        h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7],
+        _mm512_set1_epi32((int) InitialHash[0]), _mm512_set1_epi32((int) InitialHash[1]),
+        _mm512_set1_epi32((int) InitialHash[2]), _mm512_set1_epi32((int) InitialHash[3]),
+        counterLow, counterHigh, _mm512_set1_epi32(64), _mm512_set1_epi32((int) blockFlags)
+      };
+
+      round16(v, m, 0);
+      round16(v, m, 1);
+      round16(v, m, 2);
+      round16(v, m, 3);
+      round16(v, m, 4);
+      round16(v, m, 5);
+      round16(v, m, 6);
+
+      for (int i = 0; i < 8; i++)
+        h[i] = _mm512_xor_si512(v[i], v[i + 8]);
+    }
+
+    // back to one chaining value per input, the upper half of each transposed row is unused
+    for (int i = 8; i < 16; i++)
+      h[i] = _mm512_setzero_si512();
+    transpose16(h);
+    for (int lane = 0; lane < 16; lane++)
+      _mm256_storeu_si256((__m256i*)(out + 32 * lane), _mm512_castsi512_si256(h[lane]));
+  }
+
+  /// CPU supports SSE4.1 / AVX2 / AVX-512, detected once when the library is loaded
+  const bool hasSse41  = getCpuFeatures().sse41;
+  const bool hasAvx2   = getCpuFeatures().avx2;
+  const bool hasAvx512 = getCpuFeatures().avx512;
+#endif
+
+  /// hash several inputs of numBlocks blocks each, writes one chaining value per input to out,
+  /// input i uses counter + i if incrementCounter is set (chunks) or just counter (parents)
+  void hashMany(const uint8_t* const inputs[], size_t numInputs, size_t numBlocks, uint64_t counter, bool incrementCounter,
+                uint32_t flags, uint32_t flagsStart, uint32_t flagsEnd, uint8_t* out)
+  {
+    size_t step = incrementCounter ? 1 : 0;
+
+#ifdef HASH_LIBRARY_X86
+    if (hasAvx512)
+      for (; numInputs >= 16; numInputs -= 16, inputs += 16, counter += 16 * step, out += 16 * 32)
+        hash16Avx512(inputs, numBlocks, counter, incrementCounter, flags, flagsStart, flagsEnd, out);
+    if (hasAvx2)
+      for (; numInputs >= 8; numInputs -= 8, inputs += 8, counter += 8 * step, out += 8 * 32)
+        hash8Avx2(inputs, numBlocks, counter, incrementCounter, flags, flagsStart, flagsEnd, out);
+    if (hasSse41)
+      for (; numInputs >= 4; numInputs -= 4, inputs += 4, counter += 4 * step, out += 4 * 32)
+        hash4Sse41(inputs, numBlocks, counter, incrementCounter, flags, flagsStart, flagsEnd, out);
+#endif
+
+    for (; numInputs > 0; numInputs--, inputs++, counter += step, out += 32)
+      hashOne(*inputs, numBlocks, counter, flags, flagsStart, flagsEnd, out);
+  }
+}
+
+
+/// same as reset()
+BLAKE3::BLAKE3()
+{
+  reset();
+}
+
+
+/// restart
+void BLAKE3::reset()
+{
+  m_chunkCounter = 0;
+  for (int i = 0; i < 8; i++)
+    m_chunkHash[i] = InitialHash[i];
+  m_numBlocks  = 0;
+  m_bufferSize = 0;
+  m_stackSize  = 0;
+}
+
+
+/// compress the current block of m_buffer into the chunk's chaining value
+void BLAKE3::processBuffer()
+{
+  compress(m_chunkHash, m_buffer, m_chunkCounter, BlockSize, m_numBlocks == 0 ? ChunkStart : 0, m_chunkHash);
+  m_numBlocks++;
+  m_bufferSize = 0;
+}
+
+
+/// add bytes to the current chunk, at most up to its end
+void BLAKE3::addToChunk(const uint8_t* data, size_t numBytes)
+{
+  while (numBytes > 0)
+  {
+    // the last block of a chunk is compressed with a different flag, so a full block waits until more data arrives
+    if (m_bufferSize == BlockSize)
+      processBuffer();
+
+    size_t numNew = BlockSize - m_bufferSize;
+    if (numNew > numBytes)
+      numNew = numBytes;
+    memcpy(m_buffer + m_bufferSize, data, numNew);
+    m_bufferSize += numNew;
+    data         += numNew;
+    numBytes     -= numNew;
+  }
+}
+
+
+/// finish the current chunk once more data follows and push its chaining value
+void BLAKE3::finishChunk()
+{
+  uint32_t chainingValue[8];
+  compress(m_chunkHash, m_buffer, m_chunkCounter, (uint32_t) m_bufferSize,
+           ChunkEnd | (m_numBlocks == 0 ? ChunkStart : 0), chainingValue);
+  pushChainingValue(chainingValue, m_chunkCounter);
+
+  m_chunkCounter++;
+  for (int i = 0; i < 8; i++)
+    m_chunkHash[i] = InitialHash[i];
+  m_numBlocks  = 0;
+  m_bufferSize = 0;
+}
+
+
+/// merge the stack until it holds one chaining value per completed subtree before chunk chunkCounter
+void BLAKE3::mergeStack(uint64_t chunkCounter)
+{
+  // each set bit of the number of chunks so far is one completed subtree, the last two entries are only merged
+  // once more data arrives because they could have been the root's children
+  size_t numSubtrees = 0;
+  for (uint64_t bits = chunkCounter; bits != 0; bits &= bits - 1)
+    numSubtrees++;
+
+  while (m_stackSize > numSubtrees)
+  {
+    compressParent(m_stack[m_stackSize - 2], m_stack[m_stackSize - 1], 0, m_stack[m_stackSize - 2]);
+    m_stackSize--;
+  }
+}
+
+
+/// push the chaining value of the subtree starting at chunkCounter, merges the completed subtrees before it first
+void BLAKE3::pushChainingValue(const uint32_t chainingValue[8], uint64_t chunkCounter)
+{
+  mergeStack(chunkCounter);
+
+  for (int i = 0; i < 8; i++)
+    m_stack[m_stackSize][i] = chainingValue[i];
+  m_stackSize++;
+}
+
+
+/// add arbitrary number of bytes
+void BLAKE3::add(const void* data, size_t numBytes)
+{
+  const uint8_t* current = (const uint8_t*) data;
+
+  // fill the current chunk
+  if (m_numBlocks > 0 || m_bufferSize > 0)
+  {
+    size_t numNew = ChunkSize - (m_numBlocks * BlockSize + m_bufferSize);
+    if (numNew > numBytes)
+      numNew = numBytes;
+    addToChunk(current, numNew);
+    current  += numNew;
+    numBytes -= numNew;
+
+    // no more data ?
+    if (numBytes == 0)
+      return;
+
+    finishChunk();
+  }
+
+  // hash the largest complete subtrees at once, always keep at least one byte for the final chunk
+  while (numBytes > ChunkSize)
+  {
+    size_t subtreeSize = ChunkSize;
+    while (subtreeSize * 2 <= numBytes)
+      subtreeSize *= 2;
+    // a subtree can't span a boundary of a larger subtree
+    while (((m_chunkCounter * ChunkSize) & (subtreeSize - 1)) != 0)
+      subtreeSize /= 2;
+
+    if (subtreeSize == ChunkSize)
+    {
+      addToChunk(current, ChunkSize);
+      finishChunk();
+    }
+    else
+    {
+      unsigned char halves[2 * HashBytes];
+      hashSubtree(current, subtreeSize, m_chunkCounter, halves);
+      addSubtree(halves, subtreeSize);
+    }
+
+    current  += subtreeSize;
+    numBytes -= subtreeSize;
+  }
+
+  // keep remaining bytes in the current chunk, the subtrees before it can't be the root's children anymore
+  if (numBytes > 0)
+  {
+    addToChunk(current, numBytes);
+    mergeStack(m_chunkCounter);
+  }
+}
+
+
+/// hash a complete subtree and return the chaining values of its left and right half
+void BLAKE3::hashSubtree(const void* data, size_t numBytes, uint64_t chunkCounter, unsigned char halves[2 * HashBytes])
+{
+  const uint8_t* current = (const uint8_t*) data;
+  size_t numChunks = numBytes / ChunkSize;
+
+  // too large for the buffer: hash both halves independently
+  if (numChunks > MaxBufferedChunks)
+  {
+    size_t half = numBytes / 2;
+    for (int side = 0; side < 2; side++)
+    {
+      unsigned char children[2 * HashBytes];
+      hashSubtree(current + side * half, half, chunkCounter + side * (numChunks / 2), children);
+
+      const uint8_t* block = children;
+      hashMany(&block, 1, 1, 0, false, Parent, 0, 0, halves + side * HashBytes);
+    }
+    return;
+  }
+
+  // all chunks in parallel lanes, zeroed because the compiler can't see that numChunks is at least 2
+  const uint8_t* inputs[MaxBufferedChunks] = { 0 };
+  for (size_t i = 0; i < numChunks; i++)
+    inputs[i] = current + i * ChunkSize;
+  uint8_t chainingValues[MaxBufferedChunks * HashBytes];
+  hashMany(inputs, numChunks, ChunkSize / BlockSize, chunkCounter, true, 0, ChunkStart, ChunkEnd, chainingValues);
+
+  // then one level of parents after another, two adjacent chaining values form a parent's block,
+  // the results overwrite the chaining values that were already consumed
+  for (; numChunks > 2; numChunks /= 2)
+  {
+    for (size_t i = 0; i < numChunks / 2; i++)
+      inputs[i] = chainingValues + i * 2 * HashBytes;
+    hashMany(inputs, numChunks / 2, 1, 0, false, Parent, 0, 0, chainingValues);
+  }
+
+  memcpy(halves, chainingValues, 2 * HashBytes);
+}
+
+
+/// continue with a subtree hashed by hashSubtree()
+void BLAKE3::addSubtree(const unsigned char halves[2 * HashBytes], size_t numBytes)
+{
+  // a full chunk is only finished when more data arrives
+  if (m_numBlocks * BlockSize + m_bufferSize == ChunkSize)
+    finishChunk();
+
+  uint64_t numChunks = numBytes / ChunkSize;
+  for (int side = 0; side < 2; side++)
+  {
+    uint32_t chainingValue[8];
+    for (int i = 0; i < 8; i++)
+      chainingValue[i] = load32(halves + side * HashBytes + 4 * i);
+    pushChainingValue(chainingValue, m_chunkCounter + side * (numChunks / 2));
+  }
+
+  m_chunkCounter += numChunks;
+}
+
+
+/// return latest hash as 64 hex characters
+std::string BLAKE3::getHash()
+{
+  // compute hash (as raw bytes)
+  unsigned char rawHash[HashBytes];
+  getHash(rawHash);
+
+  // convert to hex string
+  std::string result;
+  result.reserve(2 * HashBytes);
+  for (int i = 0; i < HashBytes; i++)
+  {
+    static const char dec2hex[16+1] = "0123456789abcdef";
+    result += dec2hex[(rawHash[i] >> 4) & 15];
+    result += dec2hex[ rawHash[i]       & 15];
+  }
+
+  return result;
+}
+
+
+/// return latest hash as bytes
+void BLAKE3::getHash(unsigned char buffer[HashBytes])
+{
+  // the root is either the current chunk or the parent of the two most recent subtrees,
+  // then every remaining subtree on the stack becomes its left sibling, from the top down
+  uint32_t chainingValue[8];
+  uint8_t  block[BlockSize];
+  uint64_t counter;
+  uint32_t blockSize;
+  uint32_t flags;
+  size_t   numRemaining;
+
+  if (m_numBlocks > 0 || m_bufferSize > 0 || m_stackSize == 0)
+  {
+    for (int i = 0; i < 8; i++)
+      chainingValue[i] = m_chunkHash[i];
+    // zero padding, without touching the object
+    memset(block, 0, BlockSize);
+    memcpy(block, m_buffer, m_bufferSize);
+    counter      = m_chunkCounter;
+    blockSize    = (uint32_t) m_bufferSize;
+    flags        = ChunkEnd | (m_numBlocks == 0 ? ChunkStart : 0);
+    numRemaining = m_stackSize;
+  }
+  else
+  {
+    for (int i = 0; i < 8; i++)
+    {
+      chainingValue[i] = InitialHash[i];
+      store32(block +      4 * i, m_stack[m_stackSize - 2][i]);
+      store32(block + 32 + 4 * i, m_stack[m_stackSize - 1][i]);
+    }
+    counter      = 0;
+    blockSize    = BlockSize;
+    flags        = Parent;
+    numRemaining = m_stackSize - 2;
+  }
+
+  while (numRemaining > 0)
+  {
+    numRemaining--;
+
+    uint32_t right[8];
+    compress(chainingValue, block, counter, blockSize, flags, right);
+    for (int i = 0; i < 8; i++)
+    {
+      chainingValue[i] = InitialHash[i];
+      store32(block +      4 * i, m_stack[numRemaining][i]);
+      store32(block + 32 + 4 * i, right[i]);
+    }
+    counter   = 0;
+    blockSize = BlockSize;
+    flags     = Parent;
+  }
+
+  uint32_t hash[8];
+  compress(chainingValue, block, counter, blockSize, flags | Root, hash);
+  for (int i = 0; i < 8; i++)
+    store32(buffer + 4 * i, hash[i]);
+}
+
+
+/// compute hash of a memory block
+std::string BLAKE3::operator()(const void* data, size_t numBytes)
+{
+  reset();
+  add(data, numBytes);
+  return getHash();
+}
+
+
+/// compute hash of a string, excluding final zero
+std::string BLAKE3::operator()(const std::string& text)
+{
+  reset();
+  add(text.c_str(), text.size());
+  return getHash();
+}
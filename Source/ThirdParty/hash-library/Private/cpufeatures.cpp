@@ -0,0 +1,88 @@
+// //////////////////////////////////////////////////////////
+// cpufeatures.cpp
+//
+
+#include "cpufeatures.h"
+
+#ifdef HASH_LIBRARY_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+
+namespace
+{
+#ifdef HASH_LIBRARY_X86
+  /// run CPUID, registers are returned as eax, ebx, ecx, edx
+  void cpuid(unsigned int leaf, unsigned int subLeaf, unsigned int registers[4])
+  {
+#ifdef _MSC_VER
+    int result[4];
+    __cpuidex(result, (int)leaf, (int)subLeaf);
+    for (int i = 0; i < 4; i++)
+      registers[i] = (unsigned int)result[i];
+#else
+    __cpuid_count(leaf, subLeaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+  }
+
+  /// read extended control register 0, tells which register sets are saved by the operating system
+  unsigned long long xgetbv()
+  {
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    unsigned int eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((unsigned long long)edx << 32) | eax;
+#endif
+  }
+#endif
+
+  CpuFeatures detectCpuFeatures()
+  {
+    CpuFeatures features = { false, false, false, false, false, false };
+
+#ifdef HASH_LIBRARY_X86
+    unsigned int registers[4];
+    cpuid(0, 0, registers);
+    unsigned int maxLeaf = registers[0];
+    if (maxLeaf < 1)
+      return features;
+
+    cpuid(1, 0, registers);
+    features.sse41  = (registers[2] & (1u << 19)) != 0;
+    features.sse42  = (registers[2] & (1u << 20)) != 0;
+    features.pclmul = (registers[2] & (1u <<  1)) != 0;
+
+    // AVX registers are only usable if the OS saves them on context switches
+    bool osxsave = (registers[2] & (1u << 27)) != 0;
+    bool avx     = (registers[2] & (1u << 28)) != 0;
+    unsigned long long xcr0 = osxsave ? xgetbv() : 0;
+    bool ymmState = avx && (xcr0 & 0x06) == 0x06;
+    bool zmmState = ymmState && (xcr0 & 0xE0) == 0xE0;
+
+    if (maxLeaf < 7)
+      return features;
+
+    cpuid(7, 0, registers);
+    features.avx2   = ymmState && (registers[1] & (1u <<  5)) != 0;
+    features.avx512 = zmmState && (registers[1] & (1u << 16)) != 0  // AVX512F
+                               && (registers[1] & (1u << 31)) != 0; // AVX512VL
+    features.sha    = features.sse41 && (registers[1] & (1u << 29)) != 0;
+#endif
+
+    return features;
+  }
+}
+
+
+/// query CPUID once, all further calls return the cached result
+const CpuFeatures& getCpuFeatures()
+{
+  static const CpuFeatures features = detectCpuFeatures();
+  return features;
+}
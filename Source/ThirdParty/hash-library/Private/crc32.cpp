@@ -5,12 +5,17 @@
 //
 
 #include "crc32.h"
+#include "cpufeatures.h"
 
 // big endian architectures need #define __BYTE_ORDER __BIG_ENDIAN
 #ifndef _MSC_VER
 #include <endian.h>
 #endif
 
+#ifdef HASH_LIBRARY_X86
+#include <immintrin.h>
+#endif
+
 
 /// same as reset()
 CRC32::CRC32()
@@ -332,6 +337,89 @@ namespace
           ((x <<  8) & 0x00FF0000) |
            (x << 24);
   }
+
+#ifdef HASH_LIBRARY_X86
+  /// fold numBytes bytes into crc using carry-less multiplication, numBytes must be a multiple of 16 and at least 64
+  /** based on Intel's "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction",
+      all constants are bit-reflected: x^(4*128+32), x^(4*128-32), x^(128+32), x^(128-32), x^64 (mod Polynomial),
+      followed by the polynomial itself and Barrett's mu = x^64 / Polynomial
+    */
+  HASH_TARGET("pclmul,sse4.1")
+  uint32_t crc32Pclmul(uint32_t crc, const uint8_t* data, size_t numBytes)
+  {
+    const __m128i fold4   = _mm_set_epi64x(0x01C6E41596LL, 0x0154442BD4LL);
+    const __m128i fold1   = _mm_set_epi64x(0x00CCAA009ELL, 0x01751997D0LL);
+    const __m128i fold64  = _mm_set_epi64x(0,              0x0163CD6124LL);
+    const __m128i barrett = _mm_set_epi64x(0x01F7011641LL, 0x01DB710641LL);
+    const __m128i low32   = _mm_setr_epi32(~0, 0, ~0, 0);
+
+    // four independent 128 bit accumulators hide the latency of pclmulqdq
+    __m128i x0 = _mm_loadu_si128((const __m128i*)(data     ));
+    __m128i x1 = _mm_loadu_si128((const __m128i*)(data + 16));
+    __m128i x2 = _mm_loadu_si128((const __m128i*)(data + 32));
+    __m128i x3 = _mm_loadu_si128((const __m128i*)(data + 48));
+    x0 = _mm_xor_si128(x0, _mm_cvtsi32_si128((int)crc));
+    data     += 64;
+    numBytes -= 64;
+
+    while (numBytes >= 64)
+    {
+      __m128i y0 = _mm_clmulepi64_si128(x0, fold4, 0x00);
+      __m128i y1 = _mm_clmulepi64_si128(x1, fold4, 0x00);
+      __m128i y2 = _mm_clmulepi64_si128(x2, fold4, 0x00);
+      __m128i y3 = _mm_clmulepi64_si128(x3, fold4, 0x00);
+      x0 = _mm_clmulepi64_si128(x0, fold4, 0x11);
+      x1 = _mm_clmulepi64_si128(x1, fold4, 0x11);
+      x2 = _mm_clmulepi64_si128(x2, fold4, 0x11);
+      x3 = _mm_clmulepi64_si128(x3, fold4, 0x11);
+      x0 = _mm_xor_si128(_mm_xor_si128(x0, y0), _mm_loadu_si128((const __m128i*)(data     )));
+      x1 = _mm_xor_si128(_mm_xor_si128(x1, y1), _mm_loadu_si128((const __m128i*)(data + 16)));
+      x2 = _mm_xor_si128(_mm_xor_si128(x2, y2), _mm_loadu_si128((const __m128i*)(data + 32)));
+      x3 = _mm_xor_si128(_mm_xor_si128(x3, y3), _mm_loadu_si128((const __m128i*)(data + 48)));
+      data     += 64;
+      numBytes -= 64;
+    }
+
+    // fold accumulators into a single one
+    __m128i y;
+    y  = _mm_clmulepi64_si128(x0, fold1, 0x00);
+    x0 = _mm_clmulepi64_si128(x0, fold1, 0x11);
+    x0 = _mm_xor_si128(_mm_xor_si128(x0, y), x1);
+    y  = _mm_clmulepi64_si128(x0, fold1, 0x00);
+    x0 = _mm_clmulepi64_si128(x0, fold1, 0x11);
+    x0 = _mm_xor_si128(_mm_xor_si128(x0, y), x2);
+    y  = _mm_clmulepi64_si128(x0, fold1, 0x00);
+    x0 = _mm_clmulepi64_si128(x0, fold1, 0x11);
+    x0 = _mm_xor_si128(_mm_xor_si128(x0, y), x3);
+
+    // remaining 16 byte blocks
+    while (numBytes >= 16)
+    {
+      y  = _mm_clmulepi64_si128(x0, fold1, 0x00);
+      x0 = _mm_clmulepi64_si128(x0, fold1, 0x11);
+      x0 = _mm_xor_si128(_mm_xor_si128(x0, y), _mm_loadu_si128((const __m128i*)data));
+      data     += 16;
+      numBytes -= 16;
+    }
+
+    // 128 => 64 bits
+    y  = _mm_clmulepi64_si128(x0, fold1, 0x10);
+    x0 = _mm_xor_si128(_mm_srli_si128(x0, 8), y);
+    y  = _mm_srli_si128(x0, 4);
+    x0 = _mm_clmulepi64_si128(_mm_and_si128(x0, low32), fold64, 0x00);
+    x0 = _mm_xor_si128(x0, y);
+
+    // Barrett reduction 64 => 32 bits
+    y = _mm_clmulepi64_si128(_mm_and_si128(x0, low32), barrett, 0x10);
+    y = _mm_clmulepi64_si128(_mm_and_si128(y,  low32), barrett, 0x00);
+    x0 = _mm_xor_si128(x0, y);
+
+    return (uint32_t)_mm_extract_epi32(x0, 1);
+  }
+
+  /// CPU supports carry-less multiplication, detected once when the library is loaded
+  const bool hasPclmul = getCpuFeatures().pclmul && getCpuFeatures().sse41;
+#endif
 }
 
 
@@ -341,6 +429,17 @@ void CRC32::add(const void* data, size_t numBytes)
   uint32_t* current = (uint32_t*) data;
   uint32_t crc = ~m_hash;
 
+#ifdef HASH_LIBRARY_X86
+  // fold as many 16 byte blocks as possible, the look-up tables only handle the last few bytes
+  if (hasPclmul && numBytes >= 64)
+  {
+    size_t numFolded = numBytes & ~(size_t)15;
+    crc = crc32Pclmul(crc, (const uint8_t*) data, numFolded);
+    current   = (uint32_t*) ((const uint8_t*) data + numFolded);
+    numBytes -= numFolded;
+  }
+#endif
+
   // process eight bytes at once
   while (numBytes >= 8)
   {
@@ -379,6 +478,70 @@ void CRC32::add(const void* data, size_t numBytes)
 }
 
 
+namespace
+{
+  /// multiply a 32x32 bit matrix over GF(2) by a vector
+  uint32_t gf2MatrixTimes(const uint32_t matrix[32], uint32_t vector)
+  {
+    uint32_t sum = 0;
+    for (int i = 0; vector != 0; i++, vector >>= 1)
+      if (vector & 1)
+        sum ^= matrix[i];
+    return sum;
+  }
+
+  /// square = matrix * matrix
+  void gf2MatrixSquare(uint32_t square[32], const uint32_t matrix[32])
+  {
+    for (int i = 0; i < 32; i++)
+      square[i] = gf2MatrixTimes(matrix, matrix[i]);
+  }
+}
+
+
+/// CRC32 of the concatenation A+B, given the CRC32 of A, the CRC32 of B and the length of B
+uint32_t CRC32::combine(uint32_t crcA, uint32_t crcB, uint64_t lengthB)
+{
+  // same algorithm as zlib's crc32_combine():
+  // appending lengthB zero bytes to A is a linear operation, it's computed by repeated squaring of
+  // the matrix that appends a single zero bit
+  if (lengthB == 0)
+    return crcA;
+
+  uint32_t even[32]; // operator for an even number of zero bits
+  uint32_t odd [32]; // operator for an odd  number of zero bits
+
+  // one zero bit
+  odd[0] = 0xEDB88320; // reflected polynomial
+  uint32_t row = 1;
+  for (int i = 1; i < 32; i++, row <<= 1)
+    odd[i] = row;
+
+  // two zero bits
+  gf2MatrixSquare(even, odd);
+  // four zero bits
+  gf2MatrixSquare(odd, even);
+
+  // apply lengthB zero bytes to crcA (first square yields the operator for one zero byte)
+  do
+  {
+    gf2MatrixSquare(even, odd);
+    if (lengthB & 1)
+      crcA = gf2MatrixTimes(even, crcA);
+    lengthB >>= 1;
+    if (lengthB == 0)
+      break;
+
+    gf2MatrixSquare(odd, even);
+    if (lengthB & 1)
+      crcA = gf2MatrixTimes(odd, crcA);
+    lengthB >>= 1;
+  } while (lengthB != 0);
+
+  return crcA ^ crcB;
+}
+
+
 /// return latest hash as 8 hex characters
 std::string CRC32::getHash()
 {
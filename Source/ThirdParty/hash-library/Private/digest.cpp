@@ -4,12 +4,14 @@
 // see http://create.stephan-brumme.com/disclaimer.html
 //
 
-// g++ -O3 digest.cpp crc32.cpp md5.cpp sha1.cpp sha256.cpp keccak.cpp sha3.cpp -o digest
+// g++ -O3 digest.cpp cpufeatures.cpp blake3.cpp crc32.cpp crc32c.cpp md5.cpp sha1.cpp sha256.cpp sha512.cpp keccakf1600.cpp keccak.cpp sha3.cpp -o digest
 
+#include "blake3.h"
 #include "crc32.h"
 #include "md5.h"
 #include "sha1.h"
 #include "sha256.h"
+#include "sha512.h"
 #include "keccak.h"
 #include "sha3.h"
 
@@ -22,7 +24,7 @@ int main(int argc, char** argv)
   // syntax check
   if (argc < 2 || argc > 3)
   {
-    std::cout << "./digest filename [--crc|--md5|--sha1|--sha256|--keccak|--sha3]" << std::endl;
+    std::cout << "./digest filename [--crc|--md5|--sha1|--sha256|--sha512|--keccak|--sha3|--blake3]" << std::endl;
     return 1;
   }
 
@@ -33,15 +35,19 @@ int main(int argc, char** argv)
   bool computeMd5       = algorithm.empty() || algorithm == "--md5";
   bool computeSha1      = algorithm.empty() || algorithm == "--sha1";
   bool computeSha2      = algorithm.empty() || algorithm == "--sha2" || algorithm == "--sha256";
+  bool computeSha512    = algorithm.empty() || algorithm == "--sha512";
   bool computeKeccak    = algorithm.empty() || algorithm == "--keccak";
   bool computeSha3      = algorithm.empty() || algorithm == "--sha3";
+  bool computeBlake3    = algorithm.empty() || algorithm == "--blake3";
 
   CRC32  digestCrc32;
   MD5    digestMd5;
   SHA1   digestSha1;
   SHA256 digestSha2;
+  SHA512 digestSha512;
   Keccak digestKeccak(Keccak::Keccak256);
   SHA3   digestSha3  (SHA3  ::Bits256);
+  BLAKE3 digestBlake3;
 
   // each cycle processes about 1 MByte (divisible by 144 => improves Keccak/SHA3 performance)
   const size_t BufferSize = 144*7*1024;
@@ -82,10 +88,14 @@ int main(int argc, char** argv)
       digestSha1  .add(buffer, numBytesRead);
     if (computeSha2)
       digestSha2  .add(buffer, numBytesRead);
+    if (computeSha512)
+      digestSha512.add(buffer, numBytesRead);
     if (computeKeccak)
       digestKeccak.add(buffer, numBytesRead);
     if (computeSha3)
       digestSha3  .add(buffer, numBytesRead);
+    if (computeBlake3)
+      digestBlake3.add(buffer, numBytesRead);
   }
 
   // clean up
@@ -101,10 +111,14 @@ int main(int argc, char** argv)
     std::cout << "SHA1:       " << digestSha1  .getHash() << std::endl;
   if (computeSha2)
     std::cout << "SHA2/256:   " << digestSha2  .getHash() << std::endl;
+  if (computeSha512)
+    std::cout << "SHA2/512:   " << digestSha512.getHash() << std::endl;
   if (computeKeccak)
     std::cout << "Keccak/256: " << digestKeccak.getHash() << std::endl;
   if (computeSha3)
     std::cout << "SHA3/256:   " << digestSha3  .getHash() << std::endl;
+  if (computeBlake3)
+    std::cout << "BLAKE3:     " << digestBlake3.getHash() << std::endl;
 
   return 0;
 }
@@ -0,0 +1,126 @@
+// //////////////////////////////////////////////////////////
+// hashmany.h
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <string.h>
+
+// define fixed size integer types
+#ifdef _MSC_VER
+// Windows
+typedef unsigned __int8  uint8_t;
+typedef unsigned __int32 uint32_t;
+typedef unsigned __int64 uint64_t;
+#else
+// GCC
+#include <stdint.h>
+#endif
+
+
+/// lane scheduler of the multi-buffer hashMany() of MD5 and SHA256
+
+/// one of the interleaved messages processed by hashManyInterleaved()
+struct HashManyLane
+{
+  /// index of the message, numMessages if lane is idle
+  size_t         message;
+  /// start of message
+  const uint8_t* data;
+  /// number of blocks read directly from the message
+  size_t         fullBlocks;
+  /// number of blocks including 1 or 2 padding blocks
+  size_t         numBlocks;
+  /// next block to process
+  size_t         current;
+  /// final partial block plus padding
+  uint8_t        tail[2 * 64];
+};
+
+/// hash many messages, NumLanes at a time, an idle lane immediately picks up the next message
+/** NumWords:      32 bit words of state and hash (4 for MD5, 8 for SHA256)
+    BigEndian:     byte order of the message length and the hash (false for MD5, true for SHA256)
+    processBlocks: compresses one 64 byte block per lane into state[word][lane]
+  */
+template <int NumLanes, int NumWords, bool BigEndian>
+void hashManyInterleaved(void (*processBlocks)(uint32_t[][NumLanes], const uint8_t* const[]), const uint32_t initialHash[NumWords],
+                         size_t numMessages, const void* const data[], const size_t numBytes[], unsigned char hashes[])
+{
+  // idle lanes hash this block, their results are discarded
+  static const uint8_t Unused[64] = { 0 };
+
+#ifdef _MSC_VER
+  __declspec(align(64)) uint32_t state[NumWords][NumLanes];
+#else
+  uint32_t state[NumWords][NumLanes] __attribute__((aligned(64)));
+#endif
+  HashManyLane lanes[NumLanes];
+  const uint8_t* blocks[NumLanes];
+
+  size_t nextMessage = 0;
+  size_t numActive   = 0;
+  for (int lane = 0; lane < NumLanes; lane++)
+    lanes[lane].message = numMessages;
+
+  while (nextMessage < numMessages || numActive > 0)
+  {
+    for (int lane = 0; lane < NumLanes; lane++)
+    {
+      HashManyLane& current = lanes[lane];
+
+      // refill idle lane
+      if (current.message == numMessages && nextMessage < numMessages)
+      {
+        size_t length = numBytes[nextMessage];
+        current.message    = nextMessage;
+        current.data       = (const uint8_t*) data[nextMessage];
+        current.fullBlocks = length / 64;
+        current.current    = 0;
+        nextMessage++;
+        numActive++;
+
+        // same padding as processBuffer(): append "1" bit, zeros and the length in bits as 64 bit number
+        size_t remaining = length % 64;
+        current.numBlocks = current.fullBlocks + (remaining < 56 ? 1 : 2);
+        size_t tailSize   = (current.numBlocks - current.fullBlocks) * 64;
+        // an empty message may be a null pointer
+        if (remaining)
+          memcpy(current.tail, current.data + current.fullBlocks * 64, remaining);
+        current.tail[remaining] = 128;
+        memset(current.tail + remaining + 1, 0, tailSize - 8 - (remaining + 1));
+        uint64_t msgBits = 8 * (uint64_t) length;
+        for (int i = 0; i < 8; i++)
+          current.tail[BigEndian ? tailSize - 1 - i : tailSize - 8 + i] = (uint8_t)(msgBits >> (8 * i));
+
+        for (int i = 0; i < NumWords; i++)
+          state[i][lane] = initialHash[i];
+      }
+
+      if (current.message == numMessages)
+        blocks[lane] = Unused;
+      else if (current.current < current.fullBlocks)
+        blocks[lane] = current.data + current.current * 64;
+      else
+        blocks[lane] = current.tail + (current.current - current.fullBlocks) * 64;
+    }
+
+    processBlocks(state, blocks);
+
+    // emit finished messages
+    for (int lane = 0; lane < NumLanes; lane++)
+    {
+      HashManyLane& current = lanes[lane];
+      if (current.message == numMessages || ++current.current < current.numBlocks)
+        continue;
+
+      unsigned char* hash = hashes + current.message * NumWords * 4;
+      for (int i = 0; i < NumWords; i++)
+        for (int shift = 0; shift < 32; shift += 8)
+          *hash++ = (state[i][lane] >> (BigEndian ? 24 - shift : shift)) & 0xFF;
+
+      current.message = numMessages;
+      numActive--;
+    }
+  }
+}
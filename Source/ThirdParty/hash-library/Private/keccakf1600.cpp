@@ -0,0 +1,481 @@
+// //////////////////////////////////////////////////////////
+// keccakf1600.cpp
+//
+
+#include "keccakf1600.h"
+#include "cpufeatures.h"
+
+// big endian architectures need #define __BYTE_ORDER __BIG_ENDIAN
+#ifndef _MSC_VER
+#include <endian.h>
+#endif
+
+#include <string.h>
+
+#ifdef HASH_LIBRARY_X86
+#include <immintrin.h>
+#endif
+
+
+/// constants and local helper functions
+namespace
+{
+  const unsigned int KeccakRounds = 24;
+  const uint64_t XorMasks[KeccakRounds] =
+  {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL,
+    0x8000000080008000ULL, 0x000000000000808bULL, 0x0000000080000001ULL,
+    0x8000000080008081ULL, 0x8000000000008009ULL, 0x000000000000008aULL,
+    0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+    0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL,
+    0x8000000000008003ULL, 0x8000000000008002ULL, 0x8000000000000080ULL,
+    0x000000000000800aULL, 0x800000008000000aULL, 0x8000000080008081ULL,
+    0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+  };
+
+  /// rotate left and wrap around to the right
+  inline uint64_t rotateLeft(uint64_t x, uint8_t numBits)
+  {
+    return (x << numBits) | (x >> (64 - numBits));
+  }
+
+  /// convert litte vs big endian
+  inline uint64_t swap(uint64_t x)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap64(x);
+#endif
+#ifdef _MSC_VER
+    return _byteswap_uint64(x);
+#endif
+
+    return  (x >> 56) |
+           ((x >> 40) & 0x000000000000FF00ULL) |
+           ((x >> 24) & 0x0000000000FF0000ULL) |
+           ((x >>  8) & 0x00000000FF000000ULL) |
+           ((x <<  8) & 0x000000FF00000000ULL) |
+           ((x << 24) & 0x0000FF0000000000ULL) |
+           ((x << 40) & 0x00FF000000000000ULL) |
+            (x << 56);
+  }
+
+#if defined(__BYTE_ORDER) && (__BYTE_ORDER != 0) && (__BYTE_ORDER == __BIG_ENDIAN)
+#define LITTLEENDIAN(x) swap(x)
+#else
+#define LITTLEENDIAN(x) (x)
+#endif
+
+  /// return x % 5 for 0 <= x <= 9
+  unsigned int mod5(unsigned int x)
+  {
+    if (x < 5)
+      return x;
+
+    return x - 5;
+  }
+
+
+  /// portable permutation
+  void keccakF1600(uint64_t state[25])
+  {
+    for (unsigned int round = 0; round < KeccakRounds; round++)
+    {
+      // Theta
+      uint64_t coefficients[5];
+      for (unsigned int i = 0; i < 5; i++)
+        coefficients[i] = state[i] ^ state[i + 5] ^ state[i + 10] ^ state[i + 15] ^ state[i + 20];
+
+      for (unsigned int i = 0; i < 5; i++)
+      {
+        uint64_t one = coefficients[mod5(i + 4)] ^ rotateLeft(coefficients[mod5(i + 1)], 1);
+        state[i     ] ^= one;
+        state[i +  5] ^= one;
+        state[i + 10] ^= one;
+        state[i + 15] ^= one;
+        state[i + 20] ^= one;
+      }
+
+      // temporary
+      uint64_t one;
+
+      // Rho Pi
+      uint64_t last = state[1];
+      one = state[10]; state[10] = rotateLeft(last,  1); last = one;
+      one = state[ 7]; state[ 7] = rotateLeft(last,  3); last = one;
+      one = state[11]; state[11] = rotateLeft(last,  6); last = one;
+      one = state[17]; state[17] = rotateLeft(last, 10); last = one;
+      one = state[18]; state[18] = rotateLeft(last, 15); last = one;
+      one = state[ 3]; state[ 3] = rotateLeft(last, 21); last = one;
+      one = state[ 5]; state[ 5] = rotateLeft(last, 28); last = one;
+      one = state[16]; state[16] = rotateLeft(last, 36); last = one;
+      one = state[ 8]; state[ 8] = rotateLeft(last, 45); last = one;
+      one = state[21]; state[21] = rotateLeft(last, 55); last = one;
+      one = state[24]; state[24] = rotateLeft(last,  2); last = one;
+      one = state[ 4]; state[ 4] = rotateLeft(last, 14); last = one;
+      one = state[15]; state[15] = rotateLeft(last, 27); last = one;
+      one = state[23]; state[23] = rotateLeft(last, 41); last = one;
+      one = state[19]; state[19] = rotateLeft(last, 56); last = one;
+      one = state[13]; state[13] = rotateLeft(last,  8); last = one;
+      one = state[12]; state[12] = rotateLeft(last, 25); last = one;
+      one = state[ 2]; state[ 2] = rotateLeft(last, 43); last = one;
+      one = state[20]; state[20] = rotateLeft(last, 62); last = one;
+      one = state[14]; state[14] = rotateLeft(last, 18); last = one;
+      one = state[22]; state[22] = rotateLeft(last, 39); last = one;
+      one = state[ 9]; state[ 9] = rotateLeft(last, 61); last = one;
+      one = state[ 6]; state[ 6] = rotateLeft(last, 20); last = one;
+                       state[ 1] = rotateLeft(last, 44);
+
+      // Chi
+      for (unsigned int j = 0; j < 25; j += 5)
+      {
+        // temporaries
+        uint64_t one = state[j];
+        uint64_t two = state[j + 1];
+
+        state[j]     ^= state[j + 2] & ~two;
+        state[j + 1] ^= state[j + 3] & ~state[j + 2];
+        state[j + 2] ^= state[j + 4] & ~state[j + 3];
+        state[j + 3] ^=      one     & ~state[j + 4];
+        state[j + 4] ^=      two     & ~one;
+      }
+
+      // Iota
+      state[0] ^= XorMasks[round];
+    }
+  }
+
+
+#ifdef HASH_LIBRARY_X86
+  /// rotation offsets of Rho, same order as the state
+  const uint64_t RhoOffsets[25] =
+  {
+     0,  1, 62, 28, 27,
+    36, 44,  6, 55, 20,
+     3, 10, 43, 25, 39,
+    41, 45, 15, 21,  8,
+    18,  2, 61, 56, 14
+  };
+
+  /// AVX-512: each of the five rows of the state lives in one register (lanes 0..4)
+  HASH_TARGET("avx512f,avx512vl")
+  void keccakAbsorbAvx512(uint64_t state[25], const uint8_t* data, size_t numBlocks, size_t blockSize)
+  {
+    const __mmask8 RowMask = 0x1F;
+
+    // lane x receives lane x+1, x+2 or x-1 of the same row
+    const __m512i next1 = _mm512_setr_epi64(1, 2, 3, 4, 0, 5, 6, 7);
+    const __m512i next2 = _mm512_setr_epi64(2, 3, 4, 0, 1, 5, 6, 7);
+    const __m512i prev1 = _mm512_setr_epi64(4, 0, 1, 2, 3, 5, 6, 7);
+
+    __m512i rho[5];
+    __m512i row[5];
+    for (int y = 0; y < 5; y++)
+    {
+      rho[y] = _mm512_maskz_loadu_epi64(RowMask, &RhoOffsets[5 * y]);
+      row[y] = _mm512_maskz_loadu_epi64(RowMask, &state   [5 * y]);
+    }
+
+    // Pi: new row y, lane x = old row x, lane (x + 3y) % 5
+    // lanes 0/1 and 2/3 are gathered with permutex2var (lane + 8 refers to the second register), lane 4 separately
+    __m512i piLow[5], piHigh[5], piLast[5];
+    for (int y = 0; y < 5; y++)
+    {
+      piLow [y] = _mm512_setr_epi64((0 + 3 * y) % 5, 8 + (1 + 3 * y) % 5, 0, 0, 0, 0, 0, 0);
+      piHigh[y] = _mm512_setr_epi64(0, 0, (2 + 3 * y) % 5, 8 + (3 + 3 * y) % 5, 0, 0, 0, 0);
+      piLast[y] = _mm512_set1_epi64((4 + 3 * y) % 5);
+    }
+
+    // words per block in each row
+    __mmask8 blockMask[5];
+    size_t blockWords = blockSize / 8;
+    for (size_t y = 0; y < 5; y++)
+    {
+      size_t words = blockWords > 5 * y ? blockWords - 5 * y : 0;
+      blockMask[y] = (__mmask8)((1u << (words < 5 ? words : 5)) - 1);
+    }
+
+    for (; numBlocks > 0; numBlocks--, data += blockSize)
+    {
+      // mix data into state
+      for (int y = 0; y < 5; y++)
+        row[y] = _mm512_xor_si512(row[y], _mm512_maskz_loadu_epi64(blockMask[y], data + 40 * y));
+
+      for (unsigned int round = 0; round < KeccakRounds; round++)
+      {
+        // Theta (0x96 = three-way XOR)
+        __m512i c = _mm512_ternarylogic_epi64(row[0], row[1], row[2], 0x96);
+        c = _mm512_ternarylogic_epi64(c, row[3], row[4], 0x96);
+        __m512i cPrev = _mm512_permutexvar_epi64(prev1, c);
+        __m512i cNext = _mm512_rol_epi64(_mm512_permutexvar_epi64(next1, c), 1);
+
+        // Theta + Rho
+        for (int y = 0; y < 5; y++)
+          row[y] = _mm512_rolv_epi64(_mm512_ternarylogic_epi64(row[y], cPrev, cNext, 0x96), rho[y]);
+
+        // Pi
+        __m512i moved[5];
+        for (int y = 0; y < 5; y++)
+        {
+          __m512i low  = _mm512_permutex2var_epi64(row[0], piLow [y], row[1]);
+          __m512i high = _mm512_permutex2var_epi64(row[2], piHigh[y], row[3]);
+          moved[y] = _mm512_mask_permutexvar_epi64(_mm512_mask_blend_epi64(0x0C, low, high), 0x10, piLast[y], row[4]);
+        }
+
+        // Chi (0xD2 = a ^ (~b & c))
+        for (int y = 0; y < 5; y++)
+          row[y] = _mm512_maskz_ternarylogic_epi64(RowMask, moved[y],
+                                                   _mm512_permutexvar_epi64(next1, moved[y]),
+                                                   _mm512_permutexvar_epi64(next2, moved[y]), 0xD2);
+
+        // Iota
+        row[0] = _mm512_xor_si512(row[0], _mm512_maskz_set1_epi64(0x01, (long long) XorMasks[round]));
+      }
+    }
+
+    for (int y = 0; y < 5; y++)
+      _mm512_mask_storeu_epi64(&state[5 * y], RowMask, row[y]);
+  }
+
+
+  /// rotate four lanes to the left
+  HASH_TARGET("avx2")
+  inline __m256i rotateLeft4(__m256i x, int numBits)
+  {
+    return _mm256_or_si256(_mm256_slli_epi64(x, numBits), _mm256_srli_epi64(x, 64 - numBits));
+  }
+
+  /// AVX2: four independent states, interleaved as [word][state]
+  HASH_TARGET("avx2")
+  void keccakF1600x4Avx2(uint64_t states[25][4])
+  {
+    __m256i s[25];
+    for (int i = 0; i < 25; i++)
+      s[i] = _mm256_loadu_si256((const __m256i*) states[i]);
+
+    for (unsigned int round = 0; round < KeccakRounds; round++)
+    {
+      // Theta
+      __m256i coefficients[5];
+      for (unsigned int i = 0; i < 5; i++)
+        coefficients[i] = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(s[i], s[i + 5]),
+                                                            _mm256_xor_si256(s[i + 10], s[i + 15])), s[i + 20]);
+
+      for (unsigned int i = 0; i < 5; i++)
+      {
+        __m256i one = _mm256_xor_si256(coefficients[mod5(i + 4)], rotateLeft4(coefficients[mod5(i + 1)], 1));
+        s[i     ] = _mm256_xor_si256(s[i     ], one);
+        s[i +  5] = _mm256_xor_si256(s[i +  5], one);
+        s[i + 10] = _mm256_xor_si256(s[i + 10], one);
+        s[i + 15] = _mm256_xor_si256(s[i + 15], one);
+        s[i + 20] = _mm256_xor_si256(s[i + 20], one);
+      }
+
+      // Rho Pi
+      __m256i one;
+      __m256i last = s[1];
+      one = s[10]; s[10] = rotateLeft4(last,  1); last = one;
+      one = s[ 7]; s[ 7] = rotateLeft4(last,  3); last = one;
+      one = s[11]; s[11] = rotateLeft4(last,  6); last = one;
+      one = s[17]; s[17] = rotateLeft4(last, 10); last = one;
+      one = s[18]; s[18] = rotateLeft4(last, 15); last = one;
+      one = s[ 3]; s[ 3] = rotateLeft4(last, 21); last = one;
+      one = s[ 5]; s[ 5] = rotateLeft4(last, 28); last = one;
+      one = s[16]; s[16] = rotateLeft4(last, 36); last = one;
+      one = s[ 8]; s[ 8] = rotateLeft4(last, 45); last = one;
+      one = s[21]; s[21] = rotateLeft4(last, 55); last = one;
+      one = s[24]; s[24] = rotateLeft4(last,  2); last = one;
+      one = s[ 4]; s[ 4] = rotateLeft4(last, 14); last = one;
+      one = s[15]; s[15] = rotateLeft4(last, 27); last = one;
+      one = s[23]; s[23] = rotateLeft4(last, 41); last = one;
+      one = s[19]; s[19] = rotateLeft4(last, 56); last = one;
+      one = s[13]; s[13] = rotateLeft4(last,  8); last = one;
+      one = s[12]; s[12] = rotateLeft4(last, 25); last = one;
+      one = s[ 2]; s[ 2] = rotateLeft4(last, 43); last = one;
+      one = s[20]; s[20] = rotateLeft4(last, 62); last = one;
+      one = s[14]; s[14] = rotateLeft4(last, 18); last = one;
+      one = s[22]; s[22] = rotateLeft4(last, 39); last = one;
+      one = s[ 9]; s[ 9] = rotateLeft4(last, 61); last = one;
+      one = s[ 6]; s[ 6] = rotateLeft4(last, 20); last = one;
+                   s[ 1] = rotateLeft4(last, 44);
+
+      // Chi
+      for (unsigned int j = 0; j < 25; j += 5)
+      {
+        __m256i one = s[j];
+        __m256i two = s[j + 1];
+
+        s[j]     = _mm256_xor_si256(s[j],     _mm256_andnot_si256(two,      s[j + 2]));
+        s[j + 1] = _mm256_xor_si256(s[j + 1], _mm256_andnot_si256(s[j + 2], s[j + 3]));
+        s[j + 2] = _mm256_xor_si256(s[j + 2], _mm256_andnot_si256(s[j + 3], s[j + 4]));
+        s[j + 3] = _mm256_xor_si256(s[j + 3], _mm256_andnot_si256(s[j + 4], one));
+        s[j + 4] = _mm256_xor_si256(s[j + 4], _mm256_andnot_si256(one,      two));
+      }
+
+      // Iota
+      s[0] = _mm256_xor_si256(s[0], _mm256_set1_epi64x((long long) XorMasks[round]));
+    }
+
+    for (int i = 0; i < 25; i++)
+      _mm256_storeu_si256((__m256i*) states[i], s[i]);
+  }
+
+
+  /// one of the four interleaved messages processed by keccakHashManyAvx2()
+  struct Lane
+  {
+    /// index of the message, numMessages if lane is idle
+    size_t         message;
+    /// start of message
+    const uint8_t* data;
+    /// number of blocks read directly from the message
+    size_t         fullBlocks;
+    /// next block to process, the padded block follows after fullBlocks
+    size_t         current;
+    /// final partial block plus padding
+    uint8_t        tail[200];
+  };
+
+  /// hash many messages, four at a time, an idle lane immediately picks up the next message
+  void keccakHashManyAvx2(size_t numMessages, const void* const data[], const size_t numBytes[], unsigned char hashes[],
+                          size_t blockSize, size_t hashBytes, uint8_t padding)
+  {
+    uint64_t states[25][4];
+    Lane lanes[4];
+
+    size_t blockWords  = blockSize / 8;
+    size_t nextMessage = 0;
+    size_t numActive   = 0;
+    for (int lane = 0; lane < 4; lane++)
+      lanes[lane].message = numMessages;
+
+    while (nextMessage < numMessages || numActive > 0)
+    {
+      for (int lane = 0; lane < 4; lane++)
+      {
+        Lane& current = lanes[lane];
+
+        // refill idle lane
+        if (current.message == numMessages && nextMessage < numMessages)
+        {
+          size_t length = numBytes[nextMessage];
+          current.message    = nextMessage;
+          current.data       = (const uint8_t*) data[nextMessage];
+          current.fullBlocks = length / blockSize;
+          current.current    = 0;
+          nextMessage++;
+          numActive++;
+
+          // same padding as processBuffer()
+          size_t remaining = length % blockSize;
+          for (size_t i = 0; i < remaining; i++)
+            current.tail[i] = current.data[current.fullBlocks * blockSize + i];
+          current.tail[remaining] = padding;
+          for (size_t i = remaining + 1; i < blockSize; i++)
+            current.tail[i] = 0;
+          current.tail[blockSize - 1] |= 0x80;
+
+          for (int i = 0; i < 25; i++)
+            states[i][lane] = 0;
+        }
+
+        if (current.message == numMessages)
+          continue;
+
+        // mix data into state
+        const uint8_t* block = current.current < current.fullBlocks ? current.data + current.current * blockSize
+                                                                    : current.tail;
+        for (size_t i = 0; i < blockWords; i++)
+        {
+          uint64_t word;
+          memcpy(&word, block + 8 * i, 8);
+          states[i][lane] ^= LITTLEENDIAN(word);
+        }
+      }
+
+      keccakF1600x4Avx2(states);
+
+      // emit finished messages
+      for (int lane = 0; lane < 4; lane++)
+      {
+        Lane& current = lanes[lane];
+        if (current.message == numMessages || current.current++ < current.fullBlocks)
+          continue;
+
+        unsigned char* hash = hashes + current.message * hashBytes;
+        for (size_t i = 0; i < hashBytes; i++)
+          hash[i] = (unsigned char)(states[i / 8][lane] >> (8 * (i % 8)));
+
+        current.message = numMessages;
+        numActive--;
+      }
+    }
+  }
+
+  /// CPU supports AVX2 / AVX-512, detected once when the library is loaded
+  const bool hasAvx2   = getCpuFeatures().avx2;
+  const bool hasAvx512 = getCpuFeatures().avx512;
+#endif
+}
+
+
+/// XOR numBlocks blocks of blockSize bytes into the state, each followed by a permutation (uses AVX-512 if available)
+void keccakAbsorb(uint64_t state[25], const void* data, size_t numBlocks, size_t blockSize)
+{
+#ifdef HASH_LIBRARY_X86
+  if (hasAvx512)
+  {
+    keccakAbsorbAvx512(state, (const uint8_t*) data, numBlocks, blockSize);
+    return;
+  }
+#endif
+
+  const uint8_t* current = (const uint8_t*) data;
+  for (; numBlocks > 0; numBlocks--, current += blockSize)
+  {
+    const uint64_t* data64 = (const uint64_t*) current;
+    // mix data into state
+    for (unsigned int i = 0; i < blockSize / 8; i++)
+      state[i] ^= LITTLEENDIAN(data64[i]);
+
+    // re-compute state
+    keccakF1600(state);
+  }
+}
+
+
+/// hash many independent messages, four at a time if AVX2 is available
+void keccakHashMany(size_t numMessages, const void* const data[], const size_t numBytes[], unsigned char hashes[],
+                    size_t blockSize, size_t hashBytes, uint8_t padding)
+{
+#ifdef HASH_LIBRARY_X86
+  if (hasAvx2 && numMessages > 1)
+  {
+    keccakHashManyAvx2(numMessages, data, numBytes, hashes, blockSize, hashBytes, padding);
+    return;
+  }
+#endif
+
+  uint8_t tail[200];
+  for (size_t message = 0; message < numMessages; message++)
+  {
+    uint64_t state[25] = { 0 };
+
+    const uint8_t* current = (const uint8_t*) data[message];
+    size_t fullBlocks = numBytes[message] / blockSize;
+    keccakAbsorb(state, current, fullBlocks, blockSize);
+
+    // same padding as processBuffer()
+    size_t remaining = numBytes[message] % blockSize;
+    for (size_t i = 0; i < remaining; i++)
+      tail[i] = current[fullBlocks * blockSize + i];
+    tail[remaining] = padding;
+    for (size_t i = remaining + 1; i < blockSize; i++)
+      tail[i] = 0;
+    tail[blockSize - 1] |= 0x80;
+    keccakAbsorb(state, tail, 1, blockSize);
+
+    unsigned char* hash = hashes + message * hashBytes;
+    for (size_t i = 0; i < hashBytes; i++)
+      hash[i] = (unsigned char)(state[i / 8] >> (8 * (i % 8)));
+  }
+}
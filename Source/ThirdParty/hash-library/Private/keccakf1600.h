@@ -0,0 +1,31 @@
+// //////////////////////////////////////////////////////////
+// keccakf1600.h
+//
+
+#pragma once
+
+#include <stddef.h>
+
+// define fixed size integer types
+#ifdef _MSC_VER
+// Windows
+typedef unsigned __int8  uint8_t;
+typedef unsigned __int64 uint64_t;
+#else
+// GCC
+#include <stdint.h>
+#endif
+
+
+/// Keccak-f[1600] permutation shared by Keccak and SHA3
+
+/// XOR numBlocks blocks of blockSize bytes into the state, each followed by a permutation (uses AVX-512 if available)
+void keccakAbsorb(uint64_t state[25], const void* data, size_t numBlocks, size_t blockSize);
+
+/// hash many independent messages, four at a time if AVX2 is available
+/** blockSize:  rate in bytes, 200 - 2 * (bits / 8)
+    hashBytes:  bits / 8, each hash occupies hashBytes bytes of hashes
+    padding:    first padding byte, 0x01 for Keccak, 0x06 for SHA3
+  */
+void keccakHashMany(size_t numMessages, const void* const data[], const size_t numBytes[], unsigned char hashes[],
+                    size_t blockSize, size_t hashBytes, uint8_t padding);
@@ -5,11 +5,17 @@
 //
 
 #include "md5.h"
+#include "cpufeatures.h"
 
 #ifndef _MSC_VER
 #include <endian.h>
 #endif
 
+#ifdef HASH_LIBRARY_X86
+#include "hashmany.h"
+#include <immintrin.h>
+#endif
+
 
 /// same as reset()
 MD5::MD5()
@@ -76,6 +82,172 @@ namespace
            (x << 24);
   }
 #endif
+
+#ifdef HASH_LIBRARY_X86
+  /// sine derived constants, same as the literals in MD5::processBlock
+  const uint32_t RoundConstants[64] =
+  {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+  };
+
+  /// rotate left amounts of each step
+  const int RoundShifts[64] =
+  {
+    7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+    5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20,
+    4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+    6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21
+  };
+
+  /// index of the message word used by each step
+  inline int wordIndex(int i)
+  {
+    if (i < 16) return i;
+    if (i < 32) return (5 * i + 1) & 15;
+    if (i < 48) return (3 * i + 5) & 15;
+    return (7 * i) & 15;
+  }
+
+  /// load one 64 byte block of eight messages, transposed to 16 words x 8 lanes
+  HASH_TARGET("avx2")
+  inline void loadBlocks8(const uint8_t* const blocks[8], __m256i words[16])
+  {
+    // two halves of 8x8 words
+    for (int half = 0; half < 2; half++)
+    {
+      __m256i row[8];
+      for (int lane = 0; lane < 8; lane++)
+        row[lane] = _mm256_loadu_si256((const __m256i*)(blocks[lane] + 32 * half));
+
+      __m256i t0 = _mm256_unpacklo_epi32(row[0], row[1]);
+      __m256i t1 = _mm256_unpackhi_epi32(row[0], row[1]);
+      __m256i t2 = _mm256_unpacklo_epi32(row[2], row[3]);
+      __m256i t3 = _mm256_unpackhi_epi32(row[2], row[3]);
+      __m256i t4 = _mm256_unpacklo_epi32(row[4], row[5]);
+      __m256i t5 = _mm256_unpackhi_epi32(row[4], row[5]);
+      __m256i t6 = _mm256_unpacklo_epi32(row[6], row[7]);
+      __m256i t7 = _mm256_unpackhi_epi32(row[6], row[7]);
+
+      __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+      __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+      __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+      __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+      __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+      __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+      __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+      __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+      // MD5 is little endian, no byte swapping needed
+      __m256i* out = words + 8 * half;
+      out[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+      out[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+      out[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+      out[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+      out[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+      out[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+      out[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+      out[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+    }
+  }
+
+  /// process one 64 byte block of eight independent messages, state is interleaved as [word][lane]
+  HASH_TARGET("avx2")
+  void processBlocks8Avx2(uint32_t state[][8], const uint8_t* const blocks[])
+  {
+    __m256i words[16];
+    loadBlocks8(blocks, words);
+
+    __m256i a = _mm256_load_si256((const __m256i*) state[0]);
+    __m256i b = _mm256_load_si256((const __m256i*) state[1]);
+    __m256i c = _mm256_load_si256((const __m256i*) state[2]);
+    __m256i d = _mm256_load_si256((const __m256i*) state[3]);
+    const __m256i allOnes = _mm256_set1_epi32(-1);
+
+    for (int i = 0; i < 64; i++)
+    {
+      // same as f1() ... f4() of the scalar code
+      __m256i f;
+      if (i < 16)
+        f = _mm256_xor_si256(d, _mm256_and_si256(b, _mm256_xor_si256(c, d)));
+      else if (i < 32)
+        f = _mm256_xor_si256(c, _mm256_and_si256(d, _mm256_xor_si256(b, c)));
+      else if (i < 48)
+        f = _mm256_xor_si256(_mm256_xor_si256(b, c), d);
+      else
+        f = _mm256_xor_si256(c, _mm256_or_si256(b, _mm256_xor_si256(d, allOnes)));
+
+      __m256i x = _mm256_add_epi32(_mm256_add_epi32(a, f),
+                                   _mm256_add_epi32(_mm256_set1_epi32((int) RoundConstants[i]), words[wordIndex(i)]));
+      const __m128i shift = _mm_cvtsi32_si128(RoundShifts[i]);
+      x = _mm256_or_si256(_mm256_sll_epi32(x, shift), _mm256_srl_epi32(x, _mm_cvtsi32_si128(32 - RoundShifts[i])));
+
+      a = d; d = c; c = b; b = _mm256_add_epi32(b, x);
+    }
+
+    // update hash
+    _mm256_store_si256((__m256i*) state[0], _mm256_add_epi32(a, _mm256_load_si256((const __m256i*) state[0])));
+    _mm256_store_si256((__m256i*) state[1], _mm256_add_epi32(b, _mm256_load_si256((const __m256i*) state[1])));
+    _mm256_store_si256((__m256i*) state[2], _mm256_add_epi32(c, _mm256_load_si256((const __m256i*) state[2])));
+    _mm256_store_si256((__m256i*) state[3], _mm256_add_epi32(d, _mm256_load_si256((const __m256i*) state[3])));
+  }
+
+  /// process one 64 byte block of sixteen independent messages, state is interleaved as [word][lane]
+  HASH_TARGET("avx512f,avx2")
+  void processBlocks16Avx512(uint32_t state[][16], const uint8_t* const blocks[])
+  {
+    __m256i low[16], high[16];
+    loadBlocks8(blocks,     low);
+    loadBlocks8(blocks + 8, high);
+    __m512i words[16];
+    for (int i = 0; i < 16; i++)
+      words[i] = _mm512_inserti64x4(_mm512_castsi256_si512(low[i]), high[i], 1);
+
+    __m512i a = _mm512_load_si512(state[0]);
+    __m512i b = _mm512_load_si512(state[1]);
+    __m512i c = _mm512_load_si512(state[2]);
+    __m512i d = _mm512_load_si512(state[3]);
+
+    for (int i = 0; i < 64; i++)
+    {
+      // each mix function is a single ternary logic instruction
+      __m512i f;
+      if (i < 16)
+        f = _mm512_ternarylogic_epi32(b, c, d, 0xCA); // b ? c : d
+      else if (i < 32)
+        f = _mm512_ternarylogic_epi32(d, b, c, 0xCA); // d ? b : c
+      else if (i < 48)
+        f = _mm512_ternarylogic_epi32(b, c, d, 0x96); // b ^ c ^ d
+      else
+        f = _mm512_ternarylogic_epi32(b, c, d, 0x39); // c ^ (b | ~d)
+
+      __m512i x = _mm512_add_epi32(_mm512_add_epi32(a, f),
+                                   _mm512_add_epi32(_mm512_set1_epi32((int) RoundConstants[i]), words[wordIndex(i)]));
+      x = _mm512_rolv_epi32(x, _mm512_set1_epi32(RoundShifts[i]));
+
+      a = d; d = c; c = b; b = _mm512_add_epi32(b, x);
+    }
+
+    // update hash
+    _mm512_store_si512(state[0], _mm512_add_epi32(a, _mm512_load_si512(state[0])));
+    _mm512_store_si512(state[1], _mm512_add_epi32(b, _mm512_load_si512(state[1])));
+    _mm512_store_si512(state[2], _mm512_add_epi32(c, _mm512_load_si512(state[2])));
+    _mm512_store_si512(state[3], _mm512_add_epi32(d, _mm512_load_si512(state[3])));
+  }
+
+  /// initial state of hashMany()'s lanes, see reset()
+  const uint32_t InitialHash[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+
+  /// CPU supports AVX2 / AVX-512, detected once when the library is loaded
+  const bool hasAvx2   = getCpuFeatures().avx2;
+  const bool hasAvx512 = getCpuFeatures().avx512;
+#endif
 }
 
 
@@ -378,3 +550,30 @@ std::string MD5::operator()(const std::string& text)
   add(text.c_str(), text.size());
   return getHash();
 }
+
+
+/// compute MD5 of many independent messages, hashes must hold numMessages * HashBytes bytes
+void MD5::hashMany(size_t numMessages, const void* const data[], const size_t numBytes[], unsigned char hashes[])
+{
+#ifdef HASH_LIBRARY_X86
+  // a single message can't be vectorized, MD5 is one long dependency chain
+  if (hasAvx512 && numMessages > 8)
+  {
+    hashManyInterleaved<16, 4, false>(&processBlocks16Avx512, InitialHash, numMessages, data, numBytes, hashes);
+    return;
+  }
+  if (hasAvx2 && numMessages > 1)
+  {
+    hashManyInterleaved<8, 4, false>(&processBlocks8Avx2, InitialHash, numMessages, data, numBytes, hashes);
+    return;
+  }
+#endif
+
+  MD5 md5;
+  for (size_t i = 0; i < numMessages; i++)
+  {
+    md5.reset();
+    md5.add(data[i], numBytes[i]);
+    md5.getHash(hashes + i * HashBytes);
+  }
+}
@@ -5,12 +5,17 @@
 //
 
 #include "sha1.h"
+#include "cpufeatures.h"
 
 // big endian architectures need #define __BYTE_ORDER __BIG_ENDIAN
 #ifndef _MSC_VER
 #include <endian.h>
 #endif
 
+#ifdef HASH_LIBRARY_X86
+#include <immintrin.h>
+#endif
+
 
 /// same as reset()
 SHA1::SHA1()
@@ -71,6 +76,70 @@ namespace
           ((x <<  8) & 0x00FF0000) |
            (x << 24);
   }
+
+#ifdef HASH_LIBRARY_X86
+  /// four rounds with Intel's SHA extensions, the mix function has to be a compile time constant
+  template <int Function>
+  HASH_TARGET("sha,sse4.1")
+  inline void rounds4ShaNi(__m128i& abcd, __m128i& e, __m128i words[4], int i)
+  {
+    // W[t] = rotate(W[t-3] ^ W[t-8] ^ W[t-14] ^ W[t-16], 1)
+    if (i >= 4)
+      words[i & 3] = _mm_sha1msg2_epu32(_mm_xor_si128(_mm_sha1msg1_epu32(words[i & 3], words[(i + 1) & 3]),
+                                                      words[(i + 2) & 3]),
+                                        words[(i + 3) & 3]);
+
+    // e of the next four rounds is a of the current ones, rotated by sha1nexte
+    __m128i next = abcd;
+    if (i == 0)
+      e = _mm_add_epi32(e, words[0]);
+    else
+      e = _mm_sha1nexte_epu32(e, words[i & 3]);
+    abcd = _mm_sha1rnds4_epu32(abcd, e, Function);
+    e = next;
+  }
+
+  /// process 64 byte blocks with Intel's SHA extensions (SHA-NI)
+  HASH_TARGET("sha,sse4.1")
+  void processBlocksShaNi(uint32_t hash[5], const uint8_t* data, size_t numBlocks)
+  {
+    // reverse all 16 bytes: big endian words, and word 0 in the highest lane
+    const __m128i byteSwap = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+    // sha1rnds4 expects a in the highest lane and e in the highest lane of a separate register
+    __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*) hash), 0x1B);
+    __m128i e0   = _mm_set_epi32((int) hash[4], 0, 0, 0);
+
+    for (; numBlocks > 0; numBlocks--, data += 64)
+    {
+      __m128i oldAbcd = abcd;
+      __m128i oldE    = e0;
+
+      // message schedule: a ring buffer of the four most recent groups of four words
+      __m128i words[4];
+      for (int i = 0; i < 4; i++)
+        words[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16 * i)), byteSwap);
+
+      // 20 x 4 rounds
+      __m128i e = e0;
+      int i = 0;
+      for (; i <  5; i++) rounds4ShaNi<0>(abcd, e, words, i);
+      for (; i < 10; i++) rounds4ShaNi<1>(abcd, e, words, i);
+      for (; i < 15; i++) rounds4ShaNi<2>(abcd, e, words, i);
+      for (; i < 20; i++) rounds4ShaNi<3>(abcd, e, words, i);
+
+      // update hash
+      e0   = _mm_sha1nexte_epu32(e, oldE);
+      abcd = _mm_add_epi32(abcd, oldAbcd);
+    }
+
+    _mm_storeu_si128((__m128i*) hash, _mm_shuffle_epi32(abcd, 0x1B));
+    hash[4] = (uint32_t) _mm_extract_epi32(e0, 3);
+  }
+
+  /// CPU supports SHA-NI, detected once when the library is loaded
+  const bool hasShaNi = getCpuFeatures().sha;
+#endif
 }
 
 
@@ -152,6 +221,24 @@ void SHA1::processBlock(const void* data)
 }
 
 
+/// process one or more 64 byte blocks, picks the fastest implementation for the current CPU
+void SHA1::processBlocks(const void* data, size_t numBlocks)
+{
+  const uint8_t* current = (const uint8_t*) data;
+
+#ifdef HASH_LIBRARY_X86
+  if (hasShaNi)
+  {
+    processBlocksShaNi(m_hash, current, numBlocks);
+    return;
+  }
+#endif
+
+  for (; numBlocks > 0; numBlocks--, current += BlockSize)
+    processBlock(current);
+}
+
+
 /// add arbitrary number of bytes
 void SHA1::add(const void* data, size_t numBytes)
 {
@@ -169,7 +256,7 @@ void SHA1::add(const void* data, size_t numBytes)
   // full buffer
   if (m_bufferSize == BlockSize)
   {
-    processBlock((void*)m_buffer);
+    processBlocks(m_buffer, 1);
     m_numBytes  += BlockSize;
     m_bufferSize = 0;
   }
@@ -179,12 +266,13 @@ void SHA1::add(const void* data, size_t numBytes)
     return;
 
   // process full blocks
-  while (numBytes >= BlockSize)
+  size_t numBlocks = numBytes / BlockSize;
+  if (numBlocks > 0)
   {
-    processBlock(current);
-    current    += BlockSize;
-    m_numBytes += BlockSize;
-    numBytes   -= BlockSize;
+    processBlocks(current, numBlocks);
+    current    += numBlocks * BlockSize;
+    m_numBytes += numBlocks * BlockSize;
+    numBytes   -= numBlocks * BlockSize;
   }
 
   // keep remaining bytes in buffer
@@ -255,10 +343,10 @@ void SHA1::processBuffer()
   *addLength   = (unsigned char)( msgBits        & 0xFF);
 
   // process blocks
-  processBlock(m_buffer);
+  processBlocks(m_buffer, 1);
   // flowed over into a second block ?
   if (paddedLength > BlockSize)
-    processBlock(extra);
+    processBlocks(extra, 1);
 }
 
 
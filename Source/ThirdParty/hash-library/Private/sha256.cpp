@@ -5,12 +5,18 @@
 //
 
 #include "sha256.h"
+#include "cpufeatures.h"
 
 // big endian architectures need #define __BYTE_ORDER __BIG_ENDIAN
 #ifndef _MSC_VER
 #include <endian.h>
 #endif
 
+#ifdef HASH_LIBRARY_X86
+#include "hashmany.h"
+#include <immintrin.h>
+#endif
+
 
 /// same as reset()
 SHA256::SHA256()
@@ -73,6 +79,288 @@ namespace
     uint32_t term2 = ((a | b) & c) | (a & b); //(a & (b ^ c)) ^ (b & c);
     return term1 + term2;
   }
+
+#ifdef HASH_LIBRARY_X86
+  /// round constants, same as the literals in SHA256::processBlock
+  const uint32_t RoundConstants[64] =
+  {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+  };
+
+  /// process 64 byte blocks with Intel's SHA extensions (SHA-NI)
+  HASH_TARGET("sha,sse4.1")
+  void processBlocksShaNi(uint32_t hash[8], const uint8_t* data, size_t numBlocks)
+  {
+    // convert each 32 bit word from little endian to big endian
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    // sha256rnds2 expects the state as ABEF and CDGH
+    __m128i tmp    = _mm_loadu_si128((const __m128i*) &hash[0]);
+    __m128i state1 = _mm_loadu_si128((const __m128i*) &hash[4]);
+    tmp    = _mm_shuffle_epi32(tmp,    0xB1);     // CDAB
+    state1 = _mm_shuffle_epi32(state1, 0x1B);     // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8); // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);  // CDGH
+
+    for (; numBlocks > 0; numBlocks--, data += 64)
+    {
+      __m128i oldState0 = state0;
+      __m128i oldState1 = state1;
+
+      // message schedule: a ring buffer of the four most recent groups of four words
+      __m128i words[4];
+      for (int i = 0; i < 4; i++)
+        words[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16 * i)), byteSwap);
+
+      // 16 x 4 rounds
+      for (int i = 0; i < 16; i++)
+      {
+        if (i >= 4)
+        {
+          // W[t] = sigma1(W[t-2]) + W[t-7] + sigma0(W[t-15]) + W[t-16]
+          __m128i next = _mm_sha256msg1_epu32(words[i & 3], words[(i + 1) & 3]);
+          next = _mm_add_epi32(next, _mm_alignr_epi8(words[(i + 3) & 3], words[(i + 2) & 3], 4));
+          words[i & 3] = _mm_sha256msg2_epu32(next, words[(i + 3) & 3]);
+        }
+
+        __m128i message = _mm_add_epi32(words[i & 3], _mm_loadu_si128((const __m128i*) &RoundConstants[4 * i]));
+        state1  = _mm_sha256rnds2_epu32(state1, state0, message);
+        message = _mm_shuffle_epi32(message, 0x0E);
+        state0  = _mm_sha256rnds2_epu32(state0, state1, message);
+      }
+
+      // update hash
+      state0 = _mm_add_epi32(state0, oldState0);
+      state1 = _mm_add_epi32(state1, oldState1);
+    }
+
+    // back to ABCD and EFGH
+    tmp    = _mm_shuffle_epi32(state0, 0x1B);     // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);     // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);  // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);     // HGFE
+    _mm_storeu_si128((__m128i*) &hash[0], state0);
+    _mm_storeu_si128((__m128i*) &hash[4], state1);
+  }
+
+  /// rotate right, 8 lanes at once
+  HASH_TARGET("avx2")
+  inline __m256i rotate8(__m256i x, int c)
+  {
+    return _mm256_or_si256(_mm256_srli_epi32(x, c), _mm256_slli_epi32(x, 32 - c));
+  }
+
+  /// process one 64 byte block of eight independent messages, state is interleaved as [word][lane]
+  HASH_TARGET("avx2")
+  void processBlocks8Avx2(uint32_t state[8][8], const uint8_t* const blocks[8])
+  {
+    const __m256i byteSwap = _mm256_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL,
+                                               0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    // transpose 8 lanes x 16 words to 16 words x 8 lanes, in two halves of 8x8 words
+    __m256i words[16];
+    for (int half = 0; half < 2; half++)
+    {
+      __m256i row[8];
+      for (int lane = 0; lane < 8; lane++)
+        row[lane] = _mm256_loadu_si256((const __m256i*)(blocks[lane] + 32 * half));
+
+      __m256i t0 = _mm256_unpacklo_epi32(row[0], row[1]);
+      __m256i t1 = _mm256_unpackhi_epi32(row[0], row[1]);
+      __m256i t2 = _mm256_unpacklo_epi32(row[2], row[3]);
+      __m256i t3 = _mm256_unpackhi_epi32(row[2], row[3]);
+      __m256i t4 = _mm256_unpacklo_epi32(row[4], row[5]);
+      __m256i t5 = _mm256_unpackhi_epi32(row[4], row[5]);
+      __m256i t6 = _mm256_unpacklo_epi32(row[6], row[7]);
+      __m256i t7 = _mm256_unpackhi_epi32(row[6], row[7]);
+
+      __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+      __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+      __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+      __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+      __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+      __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+      __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+      __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+      __m256i* out = words + 8 * half;
+      out[0] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u0, u4, 0x20), byteSwap);
+      out[1] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u1, u5, 0x20), byteSwap);
+      out[2] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u2, u6, 0x20), byteSwap);
+      out[3] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u3, u7, 0x20), byteSwap);
+      out[4] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u0, u4, 0x31), byteSwap);
+      out[5] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u1, u5, 0x31), byteSwap);
+      out[6] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u2, u6, 0x31), byteSwap);
+      out[7] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u3, u7, 0x31), byteSwap);
+    }
+
+    __m256i a = _mm256_load_si256((const __m256i*) state[0]);
+    __m256i b = _mm256_load_si256((const __m256i*) state[1]);
+    __m256i c = _mm256_load_si256((const __m256i*) state[2]);
+    __m256i d = _mm256_load_si256((const __m256i*) state[3]);
+    __m256i e = _mm256_load_si256((const __m256i*) state[4]);
+    __m256i f = _mm256_load_si256((const __m256i*) state[5]);
+    __m256i g = _mm256_load_si256((const __m256i*) state[6]);
+    __m256i h = _mm256_load_si256((const __m256i*) state[7]);
+
+    for (int i = 0; i < 64; i++)
+    {
+      // extend message schedule, words[] is a ring buffer of the last 16 words
+      if (i >= 16)
+      {
+        __m256i w15 = words[(i - 15) & 15];
+        __m256i w2  = words[(i -  2) & 15];
+        __m256i s0  = _mm256_xor_si256(_mm256_xor_si256(rotate8(w15,  7), rotate8(w15, 18)), _mm256_srli_epi32(w15,  3));
+        __m256i s1  = _mm256_xor_si256(_mm256_xor_si256(rotate8(w2,  17), rotate8(w2,  19)), _mm256_srli_epi32(w2,  10));
+        words[i & 15] = _mm256_add_epi32(_mm256_add_epi32(words[i & 15], s0),
+                                         _mm256_add_epi32(words[(i - 7) & 15], s1));
+      }
+
+      // same as f1() and f2() of the scalar code
+      __m256i term1 = _mm256_xor_si256(_mm256_xor_si256(rotate8(e, 6), rotate8(e, 11)), rotate8(e, 25));
+      __m256i term2 = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+      __m256i x = _mm256_add_epi32(_mm256_add_epi32(h, _mm256_add_epi32(term1, term2)),
+                                   _mm256_add_epi32(_mm256_set1_epi32((int) RoundConstants[i]), words[i & 15]));
+      term1 = _mm256_xor_si256(_mm256_xor_si256(rotate8(a, 2), rotate8(a, 13)), rotate8(a, 22));
+      term2 = _mm256_or_si256(_mm256_and_si256(_mm256_or_si256(a, b), c), _mm256_and_si256(a, b));
+      __m256i y = _mm256_add_epi32(term1, term2);
+
+      h = g; g = f; f = e; e = _mm256_add_epi32(d, x);
+      d = c; c = b; b = a; a = _mm256_add_epi32(x, y);
+    }
+
+    // update hash
+    _mm256_store_si256((__m256i*) state[0], _mm256_add_epi32(a, _mm256_load_si256((const __m256i*) state[0])));
+    _mm256_store_si256((__m256i*) state[1], _mm256_add_epi32(b, _mm256_load_si256((const __m256i*) state[1])));
+    _mm256_store_si256((__m256i*) state[2], _mm256_add_epi32(c, _mm256_load_si256((const __m256i*) state[2])));
+    _mm256_store_si256((__m256i*) state[3], _mm256_add_epi32(d, _mm256_load_si256((const __m256i*) state[3])));
+    _mm256_store_si256((__m256i*) state[4], _mm256_add_epi32(e, _mm256_load_si256((const __m256i*) state[4])));
+    _mm256_store_si256((__m256i*) state[5], _mm256_add_epi32(f, _mm256_load_si256((const __m256i*) state[5])));
+    _mm256_store_si256((__m256i*) state[6], _mm256_add_epi32(g, _mm256_load_si256((const __m256i*) state[6])));
+    _mm256_store_si256((__m256i*) state[7], _mm256_add_epi32(h, _mm256_load_si256((const __m256i*) state[7])));
+  }
+
+  /// initial state of hashMany()'s lanes, see reset()
+  const uint32_t InitialHash[8] =
+    { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+  /// one round of the scalar code with the round constant already added to the message word
+  inline void round(uint32_t a, uint32_t b, uint32_t c, uint32_t& d, uint32_t e, uint32_t f, uint32_t g, uint32_t& h,
+                    uint32_t wordPlusConstant)
+  {
+    uint32_t x = h + f1(e,f,g) + wordPlusConstant;
+    d += x;
+    h  = x + f2(a,b,c);
+  }
+
+  /// sigma0 / sigma1 of the message schedule, 4 words of two blocks at once
+  HASH_TARGET("avx2")
+  inline __m256i sigma8(__m256i x, int rotate1, int rotate2, int shift)
+  {
+    return _mm256_xor_si256(_mm256_xor_si256(rotate8(x, rotate1), rotate8(x, rotate2)), _mm256_srli_epi32(x, shift));
+  }
+
+  /// process 64 byte blocks of one message: the message schedule of two blocks is computed with AVX2,
+  /// one block per 128 bit half, the rounds stay scalar
+  HASH_TARGET("avx2")
+  void processBlocksAvx2(uint32_t hash[8], const uint8_t* data, size_t numBlocks)
+  {
+    const __m256i byteSwap = _mm256_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL,
+                                               0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    // s1 of the last two words of a group is added to the first two words of the next group, then to the last two
+    const __m256i lowWords  = _mm256_set_epi32(0, 0, -1, -1, 0, 0, -1, -1);
+    const __m256i highWords = _mm256_set_epi32(-1, -1, 0, 0, -1, -1, 0, 0);
+
+    // message words plus round constants, of the first and second block
+#ifdef _MSC_VER
+    __declspec(align(32)) uint32_t wordsPlusConstants[2][64];
+#else
+    uint32_t wordsPlusConstants[2][64] __attribute__((aligned(32)));
+#endif
+
+    while (numBlocks > 0)
+    {
+      // a single remaining block is processed twice, the copy in the second half is discarded
+      const uint8_t* second = numBlocks > 1 ? data + 64 : data;
+
+      // ring buffer of the four most recent groups of four words, first block low, second block high
+      __m256i words[4];
+      for (int i = 0; i < 4; i++)
+        words[i] = _mm256_shuffle_epi8(_mm256_loadu2_m128i((const __m128i*)(second + 16 * i), (const __m128i*)(data + 16 * i)),
+                                       byteSwap);
+
+      for (int i = 0; i < 16; i++)
+      {
+        if (i >= 4)
+        {
+          // W[t] = sigma1(W[t-2]) + W[t-7] + sigma0(W[t-15]) + W[t-16]
+          __m256i w16 = words[i & 3];
+          __m256i w15 = _mm256_alignr_epi8(words[(i + 1) & 3], w16, 4);
+          __m256i w7  = _mm256_alignr_epi8(words[(i + 3) & 3], words[(i + 2) & 3], 4);
+          __m256i next = _mm256_add_epi32(_mm256_add_epi32(w16, w7), sigma8(w15, 7, 18, 3));
+
+          // W[t-2] and W[t-1] are in the previous group, W[t] and W[t+1] only exist after the first two words are done
+          __m256i w2 = _mm256_shuffle_epi32(words[(i + 3) & 3], 0xFE);
+          next = _mm256_add_epi32(next, _mm256_and_si256(sigma8(w2, 17, 19, 10), lowWords));
+          w2   = _mm256_shuffle_epi32(next, 0x40);
+          next = _mm256_add_epi32(next, _mm256_and_si256(sigma8(w2, 17, 19, 10), highWords));
+          words[i & 3] = next;
+        }
+
+        __m256i constants = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) &RoundConstants[4 * i]));
+        __m256i sum = _mm256_add_epi32(words[i & 3], constants);
+        _mm_store_si128((__m128i*) &wordsPlusConstants[0][4 * i], _mm256_castsi256_si128(sum));
+        _mm_store_si128((__m128i*) &wordsPlusConstants[1][4 * i], _mm256_extracti128_si256(sum, 1));
+      }
+
+      for (int block = 0; block < 2 && numBlocks > 0; block++, numBlocks--, data += 64)
+      {
+        uint32_t a = hash[0];
+        uint32_t b = hash[1];
+        uint32_t c = hash[2];
+        uint32_t d = hash[3];
+        uint32_t e = hash[4];
+        uint32_t f = hash[5];
+        uint32_t g = hash[6];
+        uint32_t h = hash[7];
+
+        const uint32_t* wk = wordsPlusConstants[block];
+        for (int i = 0; i < 64; i += 8)
+        {
+          round(a,b,c,d,e,f,g,h, wk[i    ]);
+          round(h,a,b,c,d,e,f,g, wk[i + 1]);
+          round(g,h,a,b,c,d,e,f, wk[i + 2]);
+          round(f,g,h,a,b,c,d,e, wk[i + 3]);
+          round(e,f,g,h,a,b,c,d, wk[i + 4]);
+          round(d,e,f,g,h,a,b,c, wk[i + 5]);
+          round(c,d,e,f,g,h,a,b, wk[i + 6]);
+          round(b,c,d,e,f,g,h,a, wk[i + 7]);
+        }
+
+        // update hash
+        hash[0] += a;
+        hash[1] += b;
+        hash[2] += c;
+        hash[3] += d;
+        hash[4] += e;
+        hash[5] += f;
+        hash[6] += g;
+        hash[7] += h;
+      }
+    }
+  }
+
+  /// CPU supports SHA-NI / AVX2, detected once when the library is loaded
+  const bool hasShaNi = getCpuFeatures().sha;
+  const bool hasAvx2  = getCpuFeatures().avx2;
+#endif
 }
 
 
@@ -237,6 +525,29 @@ void SHA256::processBlock(const void* data)
 }
 
 
+/// process one or more 64 byte blocks, picks the fastest implementation for the current CPU
+void SHA256::processBlocks(const void* data, size_t numBlocks)
+{
+  const uint8_t* current = (const uint8_t*) data;
+
+#ifdef HASH_LIBRARY_X86
+  if (hasShaNi)
+  {
+    processBlocksShaNi(m_hash, current, numBlocks);
+    return;
+  }
+  if (hasAvx2)
+  {
+    processBlocksAvx2(m_hash, current, numBlocks);
+    return;
+  }
+#endif
+
+  for (; numBlocks > 0; numBlocks--, current += BlockSize)
+    processBlock(current);
+}
+
+
 /// add arbitrary number of bytes
 void SHA256::add(const void* data, size_t numBytes)
 {
@@ -254,7 +565,7 @@ void SHA256::add(const void* data, size_t numBytes)
   // full buffer
   if (m_bufferSize == BlockSize)
   {
-    processBlock(m_buffer);
+    processBlocks(m_buffer, 1);
     m_numBytes  += BlockSize;
     m_bufferSize = 0;
   }
@@ -264,12 +575,13 @@ void SHA256::add(const void* data, size_t numBytes)
     return;
 
   // process full blocks
-  while (numBytes >= BlockSize)
+  size_t numBlocks = numBytes / BlockSize;
+  if (numBlocks > 0)
   {
-    processBlock(current);
-    current    += BlockSize;
-    m_numBytes += BlockSize;
-    numBytes   -= BlockSize;
+    processBlocks(current, numBlocks);
+    current    += numBlocks * BlockSize;
+    m_numBytes += numBlocks * BlockSize;
+    numBytes   -= numBlocks * BlockSize;
   }
 
   // keep remaining bytes in buffer
@@ -340,10 +652,10 @@ void SHA256::processBuffer()
   *addLength   = (unsigned char)( msgBits        & 0xFF);
 
   // process blocks
-  processBlock(m_buffer);
+  processBlocks(m_buffer, 1);
   // flowed over into a second block ?
   if (paddedLength > BlockSize)
-    processBlock(extra);
+    processBlocks(extra, 1);
 }
 
 
@@ -409,3 +721,25 @@ std::string SHA256::operator()(const std::string& text)
   add(text.c_str(), text.size());
   return getHash();
 }
+
+
+/// compute SHA256 of many independent messages, hashes must hold numMessages * HashBytes bytes
+void SHA256::hashMany(size_t numMessages, const void* const data[], const size_t numBytes[], unsigned char hashes[])
+{
+#ifdef HASH_LIBRARY_X86
+  // SHA-NI hashes a single message about as fast as AVX2 hashes eight
+  if (!hasShaNi && hasAvx2 && numMessages > 1)
+  {
+    hashManyInterleaved<8, 8, true>(&processBlocks8Avx2, InitialHash, numMessages, data, numBytes, hashes);
+    return;
+  }
+#endif
+
+  SHA256 sha256;
+  for (size_t i = 0; i < numMessages; i++)
+  {
+    sha256.reset();
+    sha256.add(data[i], numBytes[i]);
+    sha256.getHash(hashes + i * HashBytes);
+  }
+}
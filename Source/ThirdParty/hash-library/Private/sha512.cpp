@@ -0,0 +1,452 @@
+// //////////////////////////////////////////////////////////
+// sha512.cpp
+// same structure as sha256.cpp, with 64 bit words and 80 rounds
+//
+
+#include "sha512.h"
+#include "cpufeatures.h"
+
+// big endian architectures need #define __BYTE_ORDER __BIG_ENDIAN
+#ifndef _MSC_VER
+#include <endian.h>
+#endif
+
+#ifdef HASH_LIBRARY_X86
+#include <immintrin.h>
+#endif
+
+
+/// same as reset()
+SHA512::SHA512(Variant variant)
+: m_variant(variant)
+{
+  reset();
+}
+
+
+/// restart
+void SHA512::reset()
+{
+  m_numBytes   = 0;
+  m_bufferSize = 0;
+
+  // according to FIPS 180-4
+  switch (m_variant)
+  {
+  case Bits384:
+    m_hash[0] = 0xcbbb9d5dc1059ed8ULL;
+    m_hash[1] = 0x629a292a367cd507ULL;
+    m_hash[2] = 0x9159015a3070dd17ULL;
+    m_hash[3] = 0x152fecd8f70e5939ULL;
+    m_hash[4] = 0x67332667ffc00b31ULL;
+    m_hash[5] = 0x8eb44a8768581511ULL;
+    m_hash[6] = 0xdb0c2e0d64f98fa7ULL;
+    m_hash[7] = 0x47b5481dbefa4fa4ULL;
+    break;
+
+  case Bits512_256:
+    m_hash[0] = 0x22312194fc2bf72cULL;
+    m_hash[1] = 0x9f555fa3c84c64c2ULL;
+    m_hash[2] = 0x2393b86b6f53b151ULL;
+    m_hash[3] = 0x963877195940eabdULL;
+    m_hash[4] = 0x96283ee2a88effe3ULL;
+    m_hash[5] = 0xbe5e1e2553863992ULL;
+    m_hash[6] = 0x2b0199fc2c85b8aaULL;
+    m_hash[7] = 0x0eb72ddc81c52ca2ULL;
+    break;
+
+  default:
+    m_hash[0] = 0x6a09e667f3bcc908ULL;
+    m_hash[1] = 0xbb67ae8584caa73bULL;
+    m_hash[2] = 0x3c6ef372fe94f82bULL;
+    m_hash[3] = 0xa54ff53a5f1d36f1ULL;
+    m_hash[4] = 0x510e527fade682d1ULL;
+    m_hash[5] = 0x9b05688c2b3e6c1fULL;
+    m_hash[6] = 0x1f83d9abfb41bd6bULL;
+    m_hash[7] = 0x5be0cd19137e2179ULL;
+    break;
+  }
+}
+
+
+namespace
+{
+  /// round constants
+  const uint64_t RoundConstants[80] =
+  {
+    0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+    0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+    0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+    0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+    0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+    0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+    0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+    0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+    0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+    0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+    0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+    0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+    0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+    0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+    0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+    0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+    0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+    0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+    0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+    0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+  };
+
+  inline uint64_t rotate(uint64_t a, uint64_t c)
+  {
+    return (a >> c) | (a << (64 - c));
+  }
+
+  inline uint64_t swap(uint64_t x)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap64(x);
+#endif
+#ifdef MSC_VER
+    return _byteswap_uint64(x);
+#endif
+
+    return  (x >> 56) |
+           ((x >> 40) & 0x000000000000FF00ULL) |
+           ((x >> 24) & 0x0000000000FF0000ULL) |
+           ((x >>  8) & 0x00000000FF000000ULL) |
+           ((x <<  8) & 0x000000FF00000000ULL) |
+           ((x << 24) & 0x0000FF0000000000ULL) |
+           ((x << 40) & 0x00FF000000000000ULL) |
+            (x << 56);
+  }
+
+  // mix functions for processBlock()
+  inline uint64_t f1(uint64_t e, uint64_t f, uint64_t g)
+  {
+    uint64_t term1 = rotate(e, 14) ^ rotate(e, 18) ^ rotate(e, 41);
+    uint64_t term2 = (e & f) ^ (~e & g); //(g ^ (e & (f ^ g)))
+    return term1 + term2;
+  }
+
+  inline uint64_t f2(uint64_t a, uint64_t b, uint64_t c)
+  {
+    uint64_t term1 = rotate(a, 28) ^ rotate(a, 34) ^ rotate(a, 39);
+    uint64_t term2 = ((a | b) & c) | (a & b); //(a & (b ^ c)) ^ (b & c);
+    return term1 + term2;
+  }
+
+  /// one round, the round constant is already added to the message word
+  inline void round(uint64_t a, uint64_t b, uint64_t c, uint64_t& d, uint64_t e, uint64_t f, uint64_t g, uint64_t& h,
+                    uint64_t wordPlusConstant)
+  {
+    uint64_t x = h + f1(e,f,g) + wordPlusConstant;
+    d += x;
+    h  = x + f2(a,b,c);
+  }
+
+  /// convert one block to big endian words, extend to 80 words and add the round constants
+  inline void expand(const void* data, uint64_t wordsPlusConstants[80])
+  {
+    // data represented as 16x 64-bit words
+    const uint64_t* input = (const uint64_t*) data;
+    uint64_t* words = wordsPlusConstants;
+    int i;
+    for (i = 0; i < 16; i++)
+#if defined(__BYTE_ORDER) && (__BYTE_ORDER != 0) && (__BYTE_ORDER == __BIG_ENDIAN)
+      words[i] =      input[i];
+#else
+      words[i] = swap(input[i]);
+#endif
+
+    // extend to 80 words
+    for (; i < 80; i++)
+      words[i] = words[i-16] +
+                 (rotate(words[i-15],  1) ^ rotate(words[i-15],  8) ^ (words[i-15] >> 7)) +
+                 words[i-7] +
+                 (rotate(words[i- 2], 19) ^ rotate(words[i- 2], 61) ^ (words[i- 2] >> 6));
+
+    for (i = 0; i < 80; i++)
+      words[i] += RoundConstants[i];
+  }
+
+  /// 80 rounds of one block, wordsPlusConstants holds the whole message schedule
+  inline void compress(uint64_t hash[8], const uint64_t wordsPlusConstants[80])
+  {
+    uint64_t a = hash[0];
+    uint64_t b = hash[1];
+    uint64_t c = hash[2];
+    uint64_t d = hash[3];
+    uint64_t e = hash[4];
+    uint64_t f = hash[5];
+    uint64_t g = hash[6];
+    uint64_t h = hash[7];
+
+    const uint64_t* wk = wordsPlusConstants;
+    for (int i = 0; i < 80; i += 8)
+    {
+      round(a,b,c,d,e,f,g,h, wk[i    ]);
+      round(h,a,b,c,d,e,f,g, wk[i + 1]);
+      round(g,h,a,b,c,d,e,f, wk[i + 2]);
+      round(f,g,h,a,b,c,d,e, wk[i + 3]);
+      round(e,f,g,h,a,b,c,d, wk[i + 4]);
+      round(d,e,f,g,h,a,b,c, wk[i + 5]);
+      round(c,d,e,f,g,h,a,b, wk[i + 6]);
+      round(b,c,d,e,f,g,h,a, wk[i + 7]);
+    }
+
+    // update hash
+    hash[0] += a;
+    hash[1] += b;
+    hash[2] += c;
+    hash[3] += d;
+    hash[4] += e;
+    hash[5] += f;
+    hash[6] += g;
+    hash[7] += h;
+  }
+
+#ifdef HASH_LIBRARY_X86
+  /// rotate right, 4 lanes at once
+  HASH_TARGET("avx2")
+  inline __m256i rotate4(__m256i x, int c)
+  {
+    return _mm256_or_si256(_mm256_srli_epi64(x, c), _mm256_slli_epi64(x, 64 - c));
+  }
+
+  /// sigma0 / sigma1 of the message schedule, 4 words at once
+  HASH_TARGET("avx2")
+  inline __m256i sigma4(__m256i x, int rotate1, int rotate2, int shift)
+  {
+    return _mm256_xor_si256(_mm256_xor_si256(rotate4(x, rotate1), rotate4(x, rotate2)), _mm256_srli_epi64(x, shift));
+  }
+
+  /// process 128 byte blocks, the message schedule of two blocks is computed at once with AVX2 (one block in each
+  /// 128 bit half, two words per half), the rounds stay scalar
+  HASH_TARGET("avx2")
+  void processBlocksAvx2(uint64_t hash[8], const uint8_t* data, size_t numBlocks)
+  {
+    const __m256i byteSwap = _mm256_set_epi64x(0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL,
+                                               0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL);
+
+#ifdef _MSC_VER
+    __declspec(align(32)) uint64_t wordsPlusConstants[2][80];
+#else
+    uint64_t wordsPlusConstants[2][80] __attribute__((aligned(32)));
+#endif
+
+    for (; numBlocks >= 2; numBlocks -= 2, data += 2 * 128)
+    {
+      // ring buffer of the eight most recent pairs of words
+      __m256i words[8];
+      for (int i = 0; i < 40; i++)
+      {
+        if (i < 8)
+        {
+          __m256i pair = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(data + 16 * i))),
+                                                 _mm_loadu_si128((const __m128i*)(data + 128 + 16 * i)), 1);
+          words[i] = _mm256_shuffle_epi8(pair, byteSwap);
+        }
+        else
+        {
+          // W[t] = sigma1(W[t-2]) + W[t-7] + sigma0(W[t-15]) + W[t-16], W[t+1] only needs older words, too
+          __m256i w16 = words[i & 7];
+          __m256i w15 = _mm256_alignr_epi8(words[(i + 1) & 7], w16, 8);
+          __m256i w7  = _mm256_alignr_epi8(words[(i + 5) & 7], words[(i + 4) & 7], 8);
+          __m256i w2  = words[(i + 7) & 7];
+          words[i & 7] = _mm256_add_epi64(_mm256_add_epi64(w16, w7),
+                                          _mm256_add_epi64(sigma4(w15, 1, 8, 7), sigma4(w2, 19, 61, 6)));
+        }
+
+        __m256i constants = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) &RoundConstants[2 * i]));
+        __m256i sum = _mm256_add_epi64(words[i & 7], constants);
+        _mm_store_si128((__m128i*) &wordsPlusConstants[0][2 * i], _mm256_castsi256_si128(sum));
+        _mm_store_si128((__m128i*) &wordsPlusConstants[1][2 * i], _mm256_extracti128_si256(sum, 1));
+      }
+
+      compress(hash, wordsPlusConstants[0]);
+      compress(hash, wordsPlusConstants[1]);
+    }
+
+    // odd number of blocks
+    if (numBlocks > 0)
+    {
+      expand(data, wordsPlusConstants[0]);
+      compress(hash, wordsPlusConstants[0]);
+    }
+  }
+
+  /// CPU supports AVX2, detected once when the library is loaded
+  const bool hasAvx2 = getCpuFeatures().avx2;
+#endif
+}
+
+
+/// process 128 bytes
+void SHA512::processBlock(const void* data)
+{
+  uint64_t words[80];
+  expand(data, words);
+  compress(m_hash, words);
+}
+
+
+/// process one or more 128 byte blocks, picks the fastest implementation for the current CPU
+void SHA512::processBlocks(const void* data, size_t numBlocks)
+{
+  const uint8_t* current = (const uint8_t*) data;
+
+#ifdef HASH_LIBRARY_X86
+  if (hasAvx2)
+  {
+    processBlocksAvx2(m_hash, current, numBlocks);
+    return;
+  }
+#endif
+
+  for (; numBlocks > 0; numBlocks--, current += BlockSize)
+    processBlock(current);
+}
+
+
+/// add arbitrary number of bytes
+void SHA512::add(const void* data, size_t numBytes)
+{
+  const uint8_t* current = (const uint8_t*) data;
+
+  if (m_bufferSize > 0)
+  {
+    while (numBytes > 0 && m_bufferSize < BlockSize)
+    {
+      m_buffer[m_bufferSize++] = *current++;
+      numBytes--;
+    }
+  }
+
+  // full buffer
+  if (m_bufferSize == BlockSize)
+  {
+    processBlocks(m_buffer, 1);
+    m_numBytes  += BlockSize;
+    m_bufferSize = 0;
+  }
+
+  // no more data ?
+  if (numBytes == 0)
+    return;
+
+  // process full blocks
+  size_t numBlocks = numBytes / BlockSize;
+  if (numBlocks > 0)
+  {
+    processBlocks(current, numBlocks);
+    current    += numBlocks * BlockSize;
+    m_numBytes += numBlocks * BlockSize;
+    numBytes   -= numBlocks * BlockSize;
+  }
+
+  // keep remaining bytes in buffer
+  while (numBytes > 0)
+  {
+    m_buffer[m_bufferSize++] = *current++;
+    numBytes--;
+  }
+}
+
+
+/// process final block, less than 128 bytes
+void SHA512::processBuffer()
+{
+  // the input bytes are considered as bits strings, where the first bit is the most significant bit of the byte
+
+  // - append "1" bit to message
+  // - append "0" bits until message length in bit mod 1024 is 896
+  // - append length as 128 bit integer
+
+  // number of bytes including the "1" bit and the 16 byte length
+  size_t paddedLength = m_bufferSize + 1 + 16 <= BlockSize ? BlockSize : 2 * BlockSize;
+
+  // only needed if additional data flows over into a second block
+  unsigned char extra[BlockSize];
+
+  // append a "1" bit, 128 => binary 10000000
+  m_buffer[m_bufferSize] = 128;
+
+  size_t i;
+  for (i = m_bufferSize + 1; i < BlockSize; i++)
+    m_buffer[i] = 0;
+  for (; i < paddedLength; i++)
+    extra[i - BlockSize] = 0;
+
+  // add message length in bits as big endian 128 bit number, the upper 64 bits are always zero here
+  unsigned char* addLength = (paddedLength == BlockSize ? m_buffer : extra) + BlockSize - 8;
+  uint64_t msgBits = 8 * (m_numBytes + m_bufferSize);
+  for (int shift = 56; shift >= 0; shift -= 8)
+    *addLength++ = (unsigned char)((msgBits >> shift) & 0xFF);
+
+  // process blocks
+  processBlocks(m_buffer, 1);
+  // flowed over into a second block ?
+  if (paddedLength > BlockSize)
+    processBlocks(extra, 1);
+}
+
+
+/// return latest hash as hex characters
+std::string SHA512::getHash()
+{
+  // compute hash (as raw bytes)
+  unsigned char rawHash[HashBytes];
+  getHash(rawHash);
+
+  // convert to hex string
+  std::string result;
+  result.reserve(2 * (m_variant / 8));
+  for (int i = 0; i < m_variant / 8; i++)
+  {
+    static const char dec2hex[16+1] = "0123456789abcdef";
+    result += dec2hex[(rawHash[i] >> 4) & 15];
+    result += dec2hex[ rawHash[i]       & 15];
+  }
+
+  return result;
+}
+
+
+/// return latest hash as bytes
+void SHA512::getHash(unsigned char buffer[])
+{
+  // save old hash if buffer is partially filled
+  uint64_t oldHash[HashValues];
+  for (int i = 0; i < HashValues; i++)
+    oldHash[i] = m_hash[i];
+
+  // process remaining bytes
+  processBuffer();
+
+  // SHA384 and SHA512/256 are truncated
+  unsigned char* current = buffer;
+  for (int i = 0; i < m_variant / 8; i++)
+    *current++ = (unsigned char)((m_hash[i / 8] >> (56 - 8 * (i % 8))) & 0xFF);
+
+  // restore old hash
+  for (int i = 0; i < HashValues; i++)
+    m_hash[i] = oldHash[i];
+}
+
+
+/// compute hash of a memory block
+std::string SHA512::operator()(const void* data, size_t numBytes)
+{
+  reset();
+  add(data, numBytes);
+  return getHash();
+}
+
+
+/// compute hash of a string, excluding final zero
+std::string SHA512::operator()(const std::string& text)
+{
+  reset();
+  add(text.c_str(), text.size());
+  return getHash();
+}
@@ -0,0 +1,108 @@
+// //////////////////////////////////////////////////////////
+// blake3.h
+//
+
+#pragma once
+
+//#include "hash.h"
+#include <string>
+
+// define fixed size integer types
+#ifdef _MSC_VER
+// Windows
+typedef unsigned __int8  uint8_t;
+typedef unsigned __int32 uint32_t;
+typedef unsigned __int64 uint64_t;
+#else
+// GCC
+#include <stdint.h>
+#endif
+
+
+/// compute BLAKE3 hash (default 256 bit output, unkeyed)
+/** Usage:
+    BLAKE3 blake3;
+    std::string myHash  = blake3("Hello World");     // std::string
+    std::string myHash2 = blake3("How are you", 11); // arbitrary data, 11 bytes
+
+    // or in a streaming fashion:
+
+    BLAKE3 blake3;
+    while (more data available)
+      blake3.add(pointer to fresh data, number of new bytes);
+    std::string myHash3 = blake3.getHash();
+
+    // or hash a large buffer on several threads:
+
+    BLAKE3 blake3;
+    // each thread i: BLAKE3::hashSubtree(data + i * size, size, i * size / BLAKE3::ChunkSize, &halves[i * 2 * BLAKE3::HashBytes]);
+    for (i = 0; i < numSubtrees; i++)
+      blake3.addSubtree(&halves[i * 2 * BLAKE3::HashBytes], size);
+    blake3.add(remaining data, number of remaining bytes);
+    std::string myHash4 = blake3.getHash();
+
+    Note:
+    Complete chunks are hashed 16 (AVX-512), 8 (AVX2) or 4 (SSE4.1) at once if the CPU supports it.
+  */
+class BLAKE3 //: public Hash
+{
+public:
+  /// compression function works on 64 byte blocks, the tree has 1024 byte leaves, hash is 32 bytes long
+  enum { BlockSize = 64, ChunkSize = 1024, HashBytes = 32 };
+
+  /// same as reset()
+  BLAKE3();
+
+  /// compute hash of a memory block
+  std::string operator()(const void* data, size_t numBytes);
+  /// compute hash of a string, excluding final zero
+  std::string operator()(const std::string& text);
+
+  /// add arbitrary number of bytes
+  void add(const void* data, size_t numBytes);
+
+  /// return latest hash as 64 hex characters
+  std::string getHash();
+  /// return latest hash as bytes
+  void        getHash(unsigned char buffer[HashBytes]);
+
+  /// restart
+  void reset();
+
+  /// hash a complete subtree and return the chaining values of its left and right half (2 * HashBytes),
+  /// numBytes must be a power of two multiple of ChunkSize (at least two chunks) and data must start at chunk chunkCounter,
+  /// which has to be a multiple of numBytes / ChunkSize. Doesn't touch any object, so several threads can run it at once
+  static void hashSubtree(const void* data, size_t numBytes, uint64_t chunkCounter, unsigned char halves[2 * HashBytes]);
+
+  /// continue with a subtree hashed by hashSubtree(), the number of bytes added so far must be a multiple of numBytes
+  void addSubtree(const unsigned char halves[2 * HashBytes], size_t numBytes);
+
+private:
+  /// add bytes to the current chunk, at most up to its end
+  void addToChunk(const uint8_t* data, size_t numBytes);
+  /// compress the current block of m_buffer into the chunk's chaining value
+  void processBuffer();
+  /// finish the current chunk once more data follows and push its chaining value
+  void finishChunk();
+  /// merge the stack until it holds one chaining value per completed subtree before chunk chunkCounter
+  void mergeStack(uint64_t chunkCounter);
+  /// push the chaining value of the subtree starting at chunkCounter, merges the completed subtrees before it first
+  void pushChainingValue(const uint32_t chainingValue[8], uint64_t chunkCounter);
+
+  /// index of the current chunk
+  uint64_t m_chunkCounter;
+  /// chaining value of the current chunk
+  uint32_t m_chunkHash[8];
+  /// number of blocks compressed into m_chunkHash
+  size_t   m_numBlocks;
+  /// valid bytes in m_buffer
+  size_t   m_bufferSize;
+  /// bytes not processed yet
+  uint8_t  m_buffer[BlockSize];
+
+  /// chaining values of completed subtrees, 2^54 chunks hit the 64 bit byte counter limit,
+  /// merging is deferred until the next chaining value arrives which may need one more entry
+  enum { MaxStackSize = 54 + 1 };
+  uint32_t m_stack[MaxStackSize][8];
+  size_t   m_stackSize;
+};
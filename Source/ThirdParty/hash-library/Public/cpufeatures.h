@@ -0,0 +1,45 @@
+// //////////////////////////////////////////////////////////
+// cpufeatures.h
+//
+
+#pragma once
+
+// x86 / x64 targets can use the hardware accelerated code paths
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define HASH_LIBRARY_X86 1
+#endif
+
+// GCC and Clang only emit instructions of an extension if a function is explicitly compiled for it,
+// Visual C++ always accepts intrinsics
+#if defined(__GNUC__) || defined(__clang__)
+#define HASH_TARGET(extensions) __attribute__((target(extensions)))
+#else
+#define HASH_TARGET(extensions)
+#endif
+
+
+/// instruction set extensions supported by the CPU and the operating system
+/** Usage:
+    if (getCpuFeatures().sha)
+      ... use SHA-NI code path ...
+    else
+      ... use portable code ...
+  */
+struct CpuFeatures
+{
+  /// SSE4.1
+  bool sse41;
+  /// SSE4.2 (incl. crc32 instruction)
+  bool sse42;
+  /// carry-less multiplication
+  bool pclmul;
+  /// AVX2
+  bool avx2;
+  /// AVX-512 Foundation + Vector Length extensions
+  bool avx512;
+  /// Intel SHA extensions (SHA-1 and SHA-256)
+  bool sha;
+};
+
+/// query CPUID once, all further calls return the cached result
+const CpuFeatures& getCpuFeatures();
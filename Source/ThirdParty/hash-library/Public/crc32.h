@@ -14,13 +14,14 @@
 // Windows
 typedef unsigned __int8  uint8_t;
 typedef unsigned __int32 uint32_t;
+typedef unsigned __int64 uint64_t;
 #else
 // GCC
 #include <stdint.h>
 #endif
 
 
-/// compute CRC32 hash, based on Intel's Slicing-by-8 algorithm
+/// compute CRC32 hash, based on Intel's Slicing-by-8 algorithm (or PCLMULQDQ folding if the CPU supports it)
 /** Usage:
     CRC32 crc32;
     std::string myHash  = crc32("Hello World");     // std::string
@@ -63,6 +64,12 @@ public:
   /// restart
   void reset();
 
+  /// CRC32 of the concatenation A+B, given the CRC32 of A, the CRC32 of B and the length of B
+  /** crcA and crcB are the numbers shown by getHash() as hex (resp. its four bytes in big endian order).
+      This allows hashing large inputs in several independent chunks, e.g. on multiple threads.
+    */
+  static uint32_t combine(uint32_t crcA, uint32_t crcB, uint64_t lengthB);
+
 private:
   /// hash
   uint32_t m_hash;
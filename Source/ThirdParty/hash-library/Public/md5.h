@@ -33,6 +33,11 @@ typedef unsigned __int64 uint64_t;
     while (more data available)
       md5.add(pointer to fresh data, number of new bytes);
     std::string myHash3 = md5.getHash();
+
+    // or many independent messages at once:
+
+    unsigned char hashes[numMessages * MD5::HashBytes];
+    MD5::hashMany(numMessages, pointers to messages, number of bytes of each message, hashes);
   */
 class MD5 //: public Hash
 {
@@ -59,6 +64,9 @@ public:
   /// restart
   void reset();
 
+  /// compute MD5 of many independent messages (interleaved with AVX2 / AVX-512 if available), writes numMessages * HashBytes bytes
+  static void hashMany(size_t numMessages, const void* const data[], const size_t numBytes[], unsigned char hashes[]);
+
 private:
   /// process 64 bytes
   void processBlock(const void* data);
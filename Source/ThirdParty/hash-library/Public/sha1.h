@@ -62,6 +62,8 @@ public:
 private:
   /// process 64 bytes
   void processBlock(const void* data);
+  /// process several 64 byte blocks, hardware accelerated if available
+  void processBlocks(const void* data, size_t numBlocks);
   /// process everything left in the internal buffer
   void processBuffer();
 
@@ -33,6 +33,11 @@ typedef unsigned __int64 uint64_t;
     while (more data available)
       sha256.add(pointer to fresh data, number of new bytes);
     std::string myHash3 = sha256.getHash();
+
+    // or many independent messages at once:
+
+    unsigned char hashes[numMessages * SHA256::HashBytes];
+    SHA256::hashMany(numMessages, pointers to messages, number of bytes of each message, hashes);
   */
 class SHA256 //: public Hash
 {
@@ -59,9 +64,14 @@ public:
   /// restart
   void reset();
 
+  /// compute SHA256 of many independent messages (interleaved with AVX2 if available), writes numMessages * HashBytes bytes
+  static void hashMany(size_t numMessages, const void* const data[], const size_t numBytes[], unsigned char hashes[]);
+
 private:
   /// process 64 bytes
   void processBlock(const void* data);
+  /// process several 64 byte blocks, hardware accelerated if available
+  void processBlocks(const void* data, size_t numBlocks);
   /// process everything left in the internal buffer
   void processBuffer();
 
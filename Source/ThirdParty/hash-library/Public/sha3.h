@@ -52,10 +52,15 @@ public:
 
   /// return latest hash as hex characters
   std::string getHash();
+  /// return latest hash as bytes, buffer must hold bits / 8 bytes
+  void        getHash(unsigned char buffer[]);
 
   /// restart
   void reset();
 
+  /// compute hashes of many independent messages (four at a time with AVX2 if available), writes numMessages * (bits / 8) bytes
+  static void hashMany(Bits bits, size_t numMessages, const void* const data[], const size_t numBytes[], unsigned char hashes[]);
+
 private:
   /// process a full block
   void processBlock(const void* data);
@@ -0,0 +1,111 @@
+// //////////////////////////////////////////////////////////
+// sha512.h
+// same interface as sha256.h
+//
+
+#pragma once
+
+//#include "hash.h"
+#include <string>
+
+// define fixed size integer types
+#ifdef _MSC_VER
+// Windows
+typedef unsigned __int8  uint8_t;
+typedef unsigned __int32 uint32_t;
+typedef unsigned __int64 uint64_t;
+#else
+// GCC
+#include <stdint.h>
+#endif
+
+
+/// compute SHA512, SHA384 or SHA512/256 hash
+/** Usage:
+    SHA512 sha512;
+    std::string myHash  = sha512("Hello World");     // std::string
+    std::string myHash2 = sha512("How are you", 11); // arbitrary data, 11 bytes
+
+    // or in a streaming fashion:
+
+    SHA512 sha512;
+    while (more data available)
+      sha512.add(pointer to fresh data, number of new bytes);
+    std::string myHash3 = sha512.getHash();
+
+    // the truncated variants:
+
+    SHA384     sha384;
+    SHA512_256 sha512_256;
+  */
+class SHA512 //: public Hash
+{
+public:
+  /// split into 128 byte blocks (=> 1024 bits), hash is 64 bytes long
+  enum { BlockSize = 1024 / 8, HashBytes = 64 };
+
+  /// algorithm variants, all share the same compression function but differ in initial hash and digest size
+  enum Variant { Bits512 = 512, Bits384 = 384, Bits512_256 = 256 };
+
+  /// same as reset()
+  explicit SHA512(Variant variant = Bits512);
+
+  /// compute hash of a memory block
+  std::string operator()(const void* data, size_t numBytes);
+  /// compute hash of a string, excluding final zero
+  std::string operator()(const std::string& text);
+
+  /// add arbitrary number of bytes
+  void add(const void* data, size_t numBytes);
+
+  /// return latest hash as hex characters
+  std::string getHash();
+  /// return latest hash as bytes, buffer must hold variant / 8 bytes
+  void        getHash(unsigned char buffer[]);
+
+  /// restart
+  void reset();
+
+private:
+  /// process 128 bytes
+  void processBlock(const void* data);
+  /// process several 128 byte blocks, hardware accelerated if available
+  void processBlocks(const void* data, size_t numBlocks);
+  /// process everything left in the internal buffer
+  void processBuffer();
+
+  /// digest size in bits
+  Variant  m_variant;
+  /// size of processed data in bytes
+  uint64_t m_numBytes;
+  /// valid bytes in m_buffer
+  size_t   m_bufferSize;
+  /// bytes not processed yet
+  uint8_t  m_buffer[BlockSize];
+
+  enum { HashValues = HashBytes / 8 };
+  /// hash, stored as integers
+  uint64_t m_hash[HashValues];
+};
+
+
+/// compute SHA384 hash, same as SHA512(SHA512::Bits384)
+class SHA384 : public SHA512
+{
+public:
+  /// hash is 48 bytes long
+  enum { HashBytes = 384 / 8 };
+
+  SHA384() : SHA512(Bits384) {}
+};
+
+
+/// compute SHA512/256 hash, same as SHA512(SHA512::Bits512_256)
+class SHA512_256 : public SHA512
+{
+public:
+  /// hash is 32 bytes long
+  enum { HashBytes = 256 / 8 };
+
+  SHA512_256() : SHA512(Bits512_256) {}
+};
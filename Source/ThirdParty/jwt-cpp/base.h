@@ -1,6 +1,14 @@
 #pragma once
 #include <string>
 #include <array>
+#include <cstdint>
+
+// CPU detection is shared with hash-library, so there is only one CPUID probe
+#include "cpufeatures.h"
+
+#ifdef HASH_LIBRARY_X86
+#include <immintrin.h>
+#endif
 
 namespace jwt {
 	namespace alphabet {
@@ -38,131 +46,227 @@ namespace jwt {
 	public:
 		template<typename T>
 		static std::string encode(const std::string& bin) {
-			return encode(bin, T::data(), T::fill());
+			std::string res;
+			encode<T>(bin.data(), bin.size(), res, true);
+			return res;
+		}
+		/**
+		 * Encode into res, which is overwritten but keeps its capacity, so it can be reused without allocating
+		 * \param pad Append fill characters, JWTs are unpadded
+		 */
+		template<typename T>
+		static void encode(const char* bin, size_t size, std::string& res, bool pad) {
+			encode(reinterpret_cast<const unsigned char*>(bin), size, T::data(), T::fill(), pad, res);
+		}
+		/**
+		 * Decode into res, which is overwritten but keeps its capacity. The fill is optional
+		 * \return false if the input is invalid
+		 */
+		template<typename T>
+		static bool try_decode(const char* base, size_t size, std::string& res) {
+			res.clear();
+			return try_decode_append<T>(base, size, res);
 		}
+		/**
+		 * Same as try_decode(), but appends to res, so several parts can share one buffer
+		 * \return false if the input is invalid, res then has unspecified content
+		 */
 		template<typename T>
-		static std::string decode(const std::string& base) {
-			return decode(base, T::data(), T::fill());
+		static bool try_decode_append(const char* base, size_t size, std::string& res) {
+			return decode(base, size, T::data(), reverse<T>(), T::fill(), res);
 		}
 
 	private:
-		static std::string encode(const std::string& bin, const std::array<char, 64>& alphabet, const std::string& fill) {
-			size_t size = bin.size();
-			std::string res;
+		/// Sextet for every byte value, 0xFF if the byte isn't part of the alphabet
+		template<typename T>
+		static const std::array<uint8_t, 256>& reverse() {
+			static const std::array<uint8_t, 256> table = [] {
+				std::array<uint8_t, 256> res;
+				res.fill(0xFF);
+				for (size_t i = 0; i < T::data().size(); i++)
+					res[(unsigned char)T::data()[i]] = (uint8_t)i;
+				return res;
+			}();
+			return table;
+		}
 
-			// clear incomplete bytes
-			size_t fast_size = size - size % 3;
-			for (size_t i = 0; i < fast_size;) {
-				uint32_t octet_a = (unsigned char)bin[i++];
-				uint32_t octet_b = (unsigned char)bin[i++];
-				uint32_t octet_c = (unsigned char)bin[i++];
+		static void encode(const unsigned char* bin, size_t size, const std::array<char, 64>& alphabet, const std::string& fill,
+		                   bool pad, std::string& res) {
+			const size_t fast_size = size - size % 3;
+			const size_t mod = size % 3;
+			const size_t tail = mod == 0 ? 0 : (pad ? 4 : mod + 1);
+			res.resize(fast_size / 3 * 4 + tail);
+			char* out = &res[0];
 
-				uint32_t triple = (octet_a << 0x10) + (octet_b << 0x08) + octet_c;
+			size_t i = 0;
+#ifdef HASH_LIBRARY_X86
+			if (getCpuFeatures().avx2) {
+				i = encode_avx2(bin, size, out, alphabet[62], alphabet[63]);
+				out += i / 3 * 4;
+			}
+#endif
+			for (; i < fast_size; i += 3) {
+				const uint32_t triple = (uint32_t(bin[i]) << 0x10) + (uint32_t(bin[i + 1]) << 0x08) + bin[i + 2];
 
-				res += alphabet[(triple >> 3 * 6) & 0x3F];
-				res += alphabet[(triple >> 2 * 6) & 0x3F];
-				res += alphabet[(triple >> 1 * 6) & 0x3F];
-				res += alphabet[(triple >> 0 * 6) & 0x3F];
+				*out++ = alphabet[(triple >> 3 * 6) & 0x3F];
+				*out++ = alphabet[(triple >> 2 * 6) & 0x3F];
+				*out++ = alphabet[(triple >> 1 * 6) & 0x3F];
+				*out++ = alphabet[(triple >> 0 * 6) & 0x3F];
 			}
 
-			if (fast_size == size)
-				return res;
+			if (mod == 0)
+				return;
 
-			size_t mod = size % 3;
-
-			uint32_t octet_a = fast_size < size ? (unsigned char)bin[fast_size++] : 0;
-			uint32_t octet_b = fast_size < size ? (unsigned char)bin[fast_size++] : 0;
-			uint32_t octet_c = fast_size < size ? (unsigned char)bin[fast_size++] : 0;
-
-			uint32_t triple = (octet_a << 0x10) + (octet_b << 0x08) + octet_c;
-
-			switch (mod) {
-			case 1:
-				res += alphabet[(triple >> 3 * 6) & 0x3F];
-				res += alphabet[(triple >> 2 * 6) & 0x3F];
-				res += fill;
-				res += fill;
-				break;
-			case 2:
-				res += alphabet[(triple >> 3 * 6) & 0x3F];
-				res += alphabet[(triple >> 2 * 6) & 0x3F];
-				res += alphabet[(triple >> 1 * 6) & 0x3F];
-				res += fill;
-				break;
-			default:
-				break;
-			}
+			const uint32_t octet_a = bin[fast_size];
+			const uint32_t octet_b = mod == 2 ? bin[fast_size + 1] : 0;
+			const uint32_t triple = (octet_a << 0x10) + (octet_b << 0x08);
 
-			return res;
-		}
+			*out++ = alphabet[(triple >> 3 * 6) & 0x3F];
+			*out++ = alphabet[(triple >> 2 * 6) & 0x3F];
+			if (mod == 2)
+				*out++ = alphabet[(triple >> 1 * 6) & 0x3F];
 
-		static std::string decode(const std::string& base, const std::array<char, 64>& alphabet, const std::string& fill) {
-			size_t size = base.size();
+			if (pad) {
+				// the fill may be longer than one character ("%3d")
+				res.resize(res.size() - (3 - mod));
+				for (size_t n = mod; n < 3; n++)
+					res += fill;
+			}
+		}
 
+		static bool decode(const char* base, size_t size, const std::array<char, 64>& alphabet, const std::array<uint8_t, 256>& table,
+		                   const std::string& fill, std::string& res) {
 			size_t fill_cnt = 0;
-			while (size > fill.size()) {
-				if (base.substr(size - fill.size(), fill.size()) == fill) {
-					fill_cnt++;
-					size -= fill.size();
-					if(fill_cnt > 2)
-						{}//throw std::runtime_error("Invalid input");
-				}
-				else break;
+			while (size >= fill.size() && fill_cnt < 2 && base[size - 1] == fill.back()
+				&& fill.compare(0, fill.size(), base + size - fill.size(), fill.size()) == 0) {
+				fill_cnt++;
+				size -= fill.size();
 			}
 
-			if ((size + fill_cnt) % 4 != 0)
-				{}//throw std::runtime_error("Invalid input");
+			const size_t mod = size % 4;
+			if (mod == 1 || (fill_cnt != 0 && (size + fill_cnt) % 4 != 0))
+				return false;
 
-			size_t out_size = size / 4 * 3;
-			std::string res;
-			res.reserve(out_size);
-
-			auto get_sextet = [&](size_t offset) {
-				for (size_t i = 0; i < alphabet.size(); i++) {
-					if (alphabet[i] == base[offset])
-						return i;
-				}
-				return offset;//throw std::runtime_error("Invalid input");
-			};
+			const size_t fast_size = size - mod;
+			const size_t offset = res.size();
+			const size_t out_size = fast_size / 4 * 3 + (mod == 0 ? 0 : mod - 1);
+			res.resize(offset + out_size);
+			unsigned char* out = reinterpret_cast<unsigned char*>(&res[0]) + offset;
+			const unsigned char* in = reinterpret_cast<const unsigned char*>(base);
 
-			
-			size_t fast_size = size - size % 4;
-			for (size_t i = 0; i < fast_size;) {
-				uint32_t sextet_a = get_sextet(i++);
-				uint32_t sextet_b = get_sextet(i++);
-				uint32_t sextet_c = get_sextet(i++);
-				uint32_t sextet_d = get_sextet(i++);
+			size_t i = 0;
+#ifdef HASH_LIBRARY_X86
+			if (getCpuFeatures().avx2) {
+				i = decode_avx2(base, fast_size, out, out_size, alphabet[62], alphabet[63]);
+				out += i / 4 * 3;
+			}
+#endif
+			// invalid characters map to 0xFF, so checking the high bit of all sextets once at the end is enough
+			uint32_t invalid = 0;
+			for (; i < fast_size; i += 4) {
+				const uint32_t sextet_a = table[in[i]];
+				const uint32_t sextet_b = table[in[i + 1]];
+				const uint32_t sextet_c = table[in[i + 2]];
+				const uint32_t sextet_d = table[in[i + 3]];
+				invalid |= sextet_a | sextet_b | sextet_c | sextet_d;
 
-				uint32_t triple = (sextet_a << 3 * 6)
+				const uint32_t triple = (sextet_a << 3 * 6)
 					+ (sextet_b << 2 * 6)
 					+ (sextet_c << 1 * 6)
 					+ (sextet_d << 0 * 6);
 
-				res += (triple >> 2 * 8) & 0xFF;
-				res += (triple >> 1 * 8) & 0xFF;
-				res += (triple >> 0 * 8) & 0xFF;
+				*out++ = (triple >> 2 * 8) & 0xFF;
+				*out++ = (triple >> 1 * 8) & 0xFF;
+				*out++ = (triple >> 0 * 8) & 0xFF;
 			}
 
-			if (fill_cnt == 0)
-				return res;
+			if (mod != 0) {
+				const uint32_t sextet_a = table[in[fast_size]];
+				const uint32_t sextet_b = table[in[fast_size + 1]];
+				const uint32_t sextet_c = mod == 3 ? table[in[fast_size + 2]] : 0;
+				invalid |= sextet_a | sextet_b | sextet_c;
+
+				const uint32_t triple = (sextet_a << 3 * 6)
+					+ (sextet_b << 2 * 6)
+					+ (sextet_c << 1 * 6);
 
-			uint32_t triple = (get_sextet(fast_size) << 3 * 6)
-				+ (get_sextet(fast_size + 1) << 2 * 6);
-
-			switch (fill_cnt) {
-			case 1:
-				triple |= (get_sextet(fast_size + 2) << 1 * 6);
-				res += (triple >> 2 * 8) & 0xFF;
-				res += (triple >> 1 * 8) & 0xFF;
-				break;
-			case 2:
-				res += (triple >> 2 * 8) & 0xFF;
-				break;
-			default:
-				break;
+				*out++ = (triple >> 2 * 8) & 0xFF;
+				if (mod == 3)
+					*out++ = (triple >> 1 * 8) & 0xFF;
 			}
 
-			return res;
+			return (invalid & 0x80) == 0;
+		}
+
+#ifdef HASH_LIBRARY_X86
+		/// Encodes 24 bytes into 32 characters per iteration, returns the number of bytes consumed
+		HASH_TARGET("avx2")
+		static size_t encode_avx2(const unsigned char* bin, size_t size, char* out, char char62, char char63) {
+			// each 128 bit lane gets 12 bytes, every 3 bytes are spread over a 32 bit word as b1 b0 b2 b1
+			const __m256i spread = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+			                                        1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+			size_t i = 0;
+			// the second load reads 4 bytes past the 24 that are used
+			for (; i + 28 <= size; i += 24, out += 32) {
+				__m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(bin + i))),
+				                                     _mm_loadu_si128((const __m128i*)(bin + i + 12)), 1);
+				in = _mm256_shuffle_epi8(in, spread);
+
+				// move the four sextets of every word into their own bytes
+				const __m256i ac = _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040));
+				const __m256i bd = _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010));
+				const __m256i sextets = _mm256_or_si256(ac, bd);
+
+				// A-Z, a-z, 0-9 are contiguous, the last two characters depend on the alphabet
+				__m256i offset = _mm256_set1_epi8('A');
+				offset = _mm256_blendv_epi8(offset, _mm256_set1_epi8('a' - 26), _mm256_cmpgt_epi8(sextets, _mm256_set1_epi8(25)));
+				offset = _mm256_blendv_epi8(offset, _mm256_set1_epi8('0' - 52), _mm256_cmpgt_epi8(sextets, _mm256_set1_epi8(51)));
+				offset = _mm256_blendv_epi8(offset, _mm256_set1_epi8((char)(char62 - 62)), _mm256_cmpeq_epi8(sextets, _mm256_set1_epi8(62)));
+				offset = _mm256_blendv_epi8(offset, _mm256_set1_epi8((char)(char63 - 63)), _mm256_cmpeq_epi8(sextets, _mm256_set1_epi8(63)));
+
+				_mm256_storeu_si256((__m256i*)out, _mm256_add_epi8(sextets, offset));
+			}
+			return i;
+		}
+
+		/// Decodes 32 characters into 24 bytes per iteration, stops at the first block with an invalid character and
+		/// returns the number of characters consumed
+		HASH_TARGET("avx2")
+		static size_t decode_avx2(const char* base, size_t size, unsigned char* out, size_t out_size, char char62, char char63) {
+			size_t i = 0;
+			// every store writes 8 bytes past the 24 that are produced
+			for (size_t o = 0; i + 32 <= size && o + 32 <= out_size; i += 32, o += 24) {
+				const __m256i in = _mm256_loadu_si256((const __m256i*)(base + i));
+
+				// bytes >= 0x80 are negative and fall outside of all ranges
+				const __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(in, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), in));
+				const __m256i lower = _mm256_and_si256(_mm256_cmpgt_epi8(in, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), in));
+				const __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(in, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), in));
+				const __m256i is62 = _mm256_cmpeq_epi8(in, _mm256_set1_epi8(char62));
+				const __m256i is63 = _mm256_cmpeq_epi8(in, _mm256_set1_epi8(char63));
+
+				const __m256i valid = _mm256_or_si256(_mm256_or_si256(upper, lower), _mm256_or_si256(digit, _mm256_or_si256(is62, is63)));
+				if (_mm256_movemask_epi8(valid) != -1)
+					break;
+
+				__m256i offset = _mm256_and_si256(upper, _mm256_set1_epi8(-'A'));
+				offset = _mm256_or_si256(offset, _mm256_and_si256(lower, _mm256_set1_epi8(26 - 'a')));
+				offset = _mm256_or_si256(offset, _mm256_and_si256(digit, _mm256_set1_epi8(52 - '0')));
+				offset = _mm256_or_si256(offset, _mm256_and_si256(is62, _mm256_set1_epi8((char)(62 - char62))));
+				offset = _mm256_or_si256(offset, _mm256_and_si256(is63, _mm256_set1_epi8((char)(63 - char63))));
+				const __m256i sextets = _mm256_add_epi8(in, offset);
+
+				// merge four sextets into 24 bits per word, then drop the empty fourth byte of every word
+				const __m256i pairs = _mm256_maddubs_epi16(sextets, _mm256_set1_epi32(0x01400140));
+				const __m256i words = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+				const __m256i packed = _mm256_shuffle_epi8(words, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+				                                                                   2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+				const __m256i res = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+
+				_mm256_storeu_si256((__m256i*)(out + o), res);
+			}
+			return i;
 		}
+#endif
 	};
 }
@@ -0,0 +1,437 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <algorithm>
+
+namespace jwt {
+	/**
+	 * Allocation light json parser for token headers and payloads.
+	 * The document is parsed into one flat vector of nodes, every subtree is stored contiguously and each node knows where
+	 * its subtree ends, so siblings are found by skipping instead of following pointers. Keys, strings and number texts are
+	 * unescaped into one arena. Parsing a reused document doesn't allocate once both have grown large enough.
+	 * Copies are independent, nodes refer to the arena by offset.
+	 */
+	class flat_json {
+	public:
+		enum class type : uint8_t {
+			null,
+			boolean,
+			int64,
+			number,
+			string,
+			array,
+			object
+		};
+
+		struct node {
+			type kind;
+			/// Index one past the last node of this subtree, which is the next sibling
+			uint32_t end;
+			/// Number of elements or members
+			uint32_t size;
+			/// Member name inside the arena, if the parent is an object
+			uint32_t key_offset;
+			uint32_t key_size;
+			/// Unescaped string, or the number as written, inside the arena
+			uint32_t text_offset;
+			uint32_t text_size;
+			union {
+				bool boolean_value;
+				int64_t int_value;
+				double number_value;
+			};
+		};
+
+		/// Maximum nesting, deeper documents are rejected instead of risking the stack
+		static constexpr int max_depth = 64;
+
+		/**
+		 * Parse a json document
+		 * \return false if the document is malformed or the root isn't an object
+		 */
+		bool parse(std::string_view json) {
+			nodes.clear();
+			arena.clear();
+			// nothing unescapes to more bytes than it takes up in the input
+			arena.reserve(json.size());
+			pos = json.data();
+			last = json.data() + json.size();
+
+			skip_whitespace();
+			if (pos == last || *pos != '{' || !parse_value(0, 0, 0))
+				return fail();
+			skip_whitespace();
+			if (pos != last)
+				return fail();
+			return true;
+		}
+
+		const std::vector<node>& get_nodes() const noexcept { return nodes; }
+
+		std::string_view get_key(const node& n) const { return std::string_view(arena).substr(n.key_offset, n.key_size); }
+		std::string_view get_text(const node& n) const { return std::string_view(arena).substr(n.text_offset, n.text_size); }
+
+		/**
+		 * Find a member of the root object, the last one wins if the name appears more than once
+		 * \return nullptr if not present
+		 */
+		const node* find(std::string_view name) const {
+			const node* res = nullptr;
+			for_each_member([&](const node& member) {
+				if (get_key(member) == name)
+					res = &member;
+			});
+			return res;
+		}
+
+		/// Call f(const node&) for every member of the root object, in document order
+		template<typename F>
+		void for_each_member(F&& f) const {
+			if (nodes.empty())
+				return;
+			for (uint32_t i = 1; i < nodes[0].end; i = nodes[i].end)
+				f(nodes[i]);
+		}
+
+		/// Call f(const node&) for every element or member of n
+		template<typename F>
+		void for_each_child(const node& n, F&& f) const {
+			const uint32_t index = uint32_t(&n - nodes.data());
+			for (uint32_t i = index + 1; i < n.end; i = nodes[i].end)
+				f(nodes[i]);
+		}
+
+		/// Append the json text of n to res, strings are escaped the same way picojson does
+		void serialize(const node& n, std::string& res) const {
+			switch (n.kind) {
+			case type::null: res += "null"; break;
+			case type::boolean: res += n.boolean_value ? "true" : "false"; break;
+			case type::int64:
+			case type::number: res += get_text(n); break;
+			case type::string: serialize_string(get_text(n), res); break;
+			case type::array:
+			case type::object: {
+				const bool is_object = n.kind == type::object;
+				res += is_object ? '{' : '[';
+				bool first = true;
+				for_each_child(n, [&](const node& child) {
+					if (!first)
+						res += ',';
+					first = false;
+					if (is_object) {
+						serialize_string(get_key(child), res);
+						res += ':';
+					}
+					serialize(child, res);
+				});
+				res += is_object ? '}' : ']';
+				break;
+			}
+			}
+		}
+
+		static void serialize_string(std::string_view str, std::string& res) {
+			res += '"';
+			for (const char c : str) {
+				switch (c) {
+				case '"': res += "\\\""; break;
+				case '\\': res += "\\\\"; break;
+				case '/': res += "\\/"; break;
+				case '\b': res += "\\b"; break;
+				case '\f': res += "\\f"; break;
+				case '\n': res += "\\n"; break;
+				case '\r': res += "\\r"; break;
+				case '\t': res += "\\t"; break;
+				default:
+					if (static_cast<unsigned char>(c) < 0x20 || c == 0x7f) {
+						char buf[7];
+						snprintf(buf, sizeof(buf), "\\u%04x", c & 0xff);
+						res.append(buf, 6);
+					}
+					else
+						res += c;
+					break;
+				}
+			}
+			res += '"';
+		}
+
+	private:
+		std::vector<node> nodes;
+		std::string arena;
+		const char* pos = nullptr;
+		const char* last = nullptr;
+
+		bool fail() {
+			nodes.clear();
+			arena.clear();
+			return false;
+		}
+
+		void skip_whitespace() {
+			while (pos != last && (*pos == ' ' || *pos == '\t' || *pos == '\n' || *pos == '\r'))
+				++pos;
+		}
+
+		bool consume(char c) {
+			skip_whitespace();
+			if (pos == last || *pos != c)
+				return false;
+			++pos;
+			return true;
+		}
+
+		bool consume_literal(const char* literal, size_t size) {
+			if (size_t(last - pos) < size || std::string_view(pos, size) != std::string_view(literal, size))
+				return false;
+			pos += size;
+			return true;
+		}
+
+		uint32_t push(type kind, uint32_t key_offset, uint32_t key_size) {
+			node n;
+			n.kind = kind;
+			n.end = uint32_t(nodes.size() + 1);
+			n.size = 0;
+			n.key_offset = key_offset;
+			n.key_size = key_size;
+			n.text_offset = 0;
+			n.text_size = 0;
+			n.int_value = 0;
+			nodes.push_back(n);
+			return uint32_t(nodes.size() - 1);
+		}
+
+		bool parse_value(int depth, uint32_t key_offset, uint32_t key_size) {
+			skip_whitespace();
+			if (pos == last)
+				return false;
+
+			switch (*pos) {
+			case '{':
+			case '[': {
+				if (depth >= max_depth)
+					return false;
+				const bool is_object = *pos++ == '{';
+				const char close = is_object ? '}' : ']';
+				const uint32_t index = push(is_object ? type::object : type::array, key_offset, key_size);
+				uint32_t size = 0;
+				if (!consume(close)) {
+					do {
+						uint32_t member_key_offset = 0;
+						uint32_t member_key_size = 0;
+						if (is_object) {
+							skip_whitespace();
+							if (!parse_string(member_key_offset, member_key_size) || !consume(':'))
+								return false;
+						}
+						if (!parse_value(depth + 1, member_key_offset, member_key_size))
+							return false;
+						size++;
+					} while (consume(','));
+					if (!consume(close))
+						return false;
+				}
+				nodes[index].end = uint32_t(nodes.size());
+				nodes[index].size = size;
+				return true;
+			}
+			case '"': {
+				uint32_t offset, size;
+				if (!parse_string(offset, size))
+					return false;
+				const uint32_t index = push(type::string, key_offset, key_size);
+				nodes[index].text_offset = offset;
+				nodes[index].text_size = size;
+				return true;
+			}
+			case 't':
+				if (!consume_literal("true", 4))
+					return false;
+				nodes[push(type::boolean, key_offset, key_size)].boolean_value = true;
+				return true;
+			case 'f':
+				if (!consume_literal("false", 5))
+					return false;
+				nodes[push(type::boolean, key_offset, key_size)].boolean_value = false;
+				return true;
+			case 'n':
+				if (!consume_literal("null", 4))
+					return false;
+				push(type::null, key_offset, key_size);
+				return true;
+			default:
+				return parse_number(key_offset, key_size);
+			}
+		}
+
+		bool parse_number(uint32_t key_offset, uint32_t key_size) {
+			const char* begin = pos;
+			bool is_integer = true;
+			if (pos != last && *pos == '-')
+				++pos;
+			const char* digits = pos;
+			while (pos != last && *pos >= '0' && *pos <= '9')
+				++pos;
+			if (pos == digits)
+				return false;
+			if (pos != last && *pos == '.') {
+				is_integer = false;
+				const char* fraction = ++pos;
+				while (pos != last && *pos >= '0' && *pos <= '9')
+					++pos;
+				if (pos == fraction)
+					return false;
+			}
+			if (pos != last && (*pos == 'e' || *pos == 'E')) {
+				is_integer = false;
+				++pos;
+				if (pos != last && (*pos == '+' || *pos == '-'))
+					++pos;
+				const char* exponent = pos;
+				while (pos != last && *pos >= '0' && *pos <= '9')
+					++pos;
+				if (pos == exponent)
+					return false;
+			}
+
+			const uint32_t offset = uint32_t(arena.size());
+			arena.append(begin, pos);
+			const uint32_t index = push(type::int64, key_offset, key_size);
+			node& n = nodes[index];
+			n.text_offset = offset;
+			n.text_size = uint32_t(pos - begin);
+
+			if (is_integer) {
+				// accumulate negatively, so INT64_MIN fits, too
+				const bool negative = *begin == '-';
+				int64_t value = 0;
+				for (const char* c = digits; c != pos && is_integer; ++c) {
+					const int digit = *c - '0';
+					if (value < (INT64_MIN + digit) / 10)
+						is_integer = false;
+					else
+						value = value * 10 - digit;
+				}
+				if (is_integer && !negative && value == INT64_MIN)
+					is_integer = false;
+				if (is_integer) {
+					n.int_value = negative ? value : -value;
+					return true;
+				}
+			}
+
+			// the arena isn't null terminated, strtod needs a copy
+			n.kind = type::number;
+			const size_t length = size_t(pos - begin);
+			char buf[64];
+			if (length < sizeof(buf)) {
+				std::copy(begin, pos, buf);
+				buf[length] = '\0';
+				n.number_value = strtod(buf, nullptr);
+			}
+			else
+				n.number_value = strtod(std::string(begin, pos).c_str(), nullptr);
+			return true;
+		}
+
+		static int hex_value(char c) {
+			if (c >= '0' && c <= '9') return c - '0';
+			if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+			if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+			return -1;
+		}
+
+		bool parse_hex4(uint32_t& res) {
+			if (last - pos < 4)
+				return false;
+			res = 0;
+			for (int i = 0; i < 4; i++) {
+				const int value = hex_value(*pos++);
+				if (value < 0)
+					return false;
+				res = res << 4 | uint32_t(value);
+			}
+			return true;
+		}
+
+		void append_utf8(uint32_t code_point) {
+			if (code_point < 0x80)
+				arena += char(code_point);
+			else if (code_point < 0x800) {
+				arena += char(0xC0 | code_point >> 6);
+				arena += char(0x80 | (code_point & 0x3F));
+			}
+			else if (code_point < 0x10000) {
+				arena += char(0xE0 | code_point >> 12);
+				arena += char(0x80 | (code_point >> 6 & 0x3F));
+				arena += char(0x80 | (code_point & 0x3F));
+			}
+			else {
+				arena += char(0xF0 | code_point >> 18);
+				arena += char(0x80 | (code_point >> 12 & 0x3F));
+				arena += char(0x80 | (code_point >> 6 & 0x3F));
+				arena += char(0x80 | (code_point & 0x3F));
+			}
+		}
+
+		bool parse_string(uint32_t& offset, uint32_t& size) {
+			if (pos == last || *pos != '"')
+				return false;
+			++pos;
+			offset = uint32_t(arena.size());
+
+			for (;;) {
+				// copy runs without escapes in one go
+				const char* run = pos;
+				while (pos != last && *pos != '"' && *pos != '\\' && static_cast<unsigned char>(*pos) >= 0x20)
+					++pos;
+				arena.append(run, pos);
+
+				if (pos == last || static_cast<unsigned char>(*pos) < 0x20)
+					return false;
+				if (*pos++ == '"')
+					break;
+
+				if (pos == last)
+					return false;
+				switch (*pos++) {
+				case '"': arena += '"'; break;
+				case '\\': arena += '\\'; break;
+				case '/': arena += '/'; break;
+				case 'b': arena += '\b'; break;
+				case 'f': arena += '\f'; break;
+				case 'n': arena += '\n'; break;
+				case 'r': arena += '\r'; break;
+				case 't': arena += '\t'; break;
+				case 'u': {
+					uint32_t code_point;
+					if (!parse_hex4(code_point))
+						return false;
+					if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+						// high surrogate, has to be followed by the low one
+						uint32_t low;
+						if (!consume_literal("\\u", 2) || !parse_hex4(low) || low < 0xDC00 || low > 0xDFFF)
+							return false;
+						code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+					}
+					else if (code_point >= 0xDC00 && code_point <= 0xDFFF)
+						return false;
+					// \uXXXX takes 6 bytes and unescapes to at most 3, a surrogate pair takes 12 for 4
+					append_utf8(code_point);
+					break;
+				}
+				default:
+					return false;
+				}
+			}
+
+			size = uint32_t(arena.size() - offset);
+			return true;
+		}
+	};
+}
@@ -2,10 +2,12 @@
 #define PICOJSON_USE_INT64
 #include "picojson.h"
 #include "base.h"
+#include "flat_json.h"
 #include <set>
 #include <chrono>
 #include <unordered_map>
 #include <memory>
+#include <string_view>
 
 #define UI UI_ST
 THIRD_PARTY_INCLUDES_START
@@ -17,9 +19,15 @@ THIRD_PARTY_INCLUDES_START
 #include <openssl/err.h>
 #include <openssl/bn.h>
 #include <openssl/x509.h>
+#include <openssl/hmac.h>
 THIRD_PARTY_INCLUDES_END
 #undef UI
 
+// Backend of jwt::claims_document, 1 uses flat_json, 0 uses picojson
+#ifndef JWT_FLAT_JSON
+#define JWT_FLAT_JSON 1
+#endif
+
 // hidden Verify macro,it defined in Misc/AssertionMacros.h
 #ifdef verify
 	#undef verify
@@ -164,49 +172,54 @@ namespace jwt {
 		struct hmacsha {
 			/**
 			 * Construct new hmac algorithm
+			 * The key schedule (inner and outer padded key) is computed once here, signing only clones it.
 			 * \param key Key to use for HMAC
 			 * \param md Pointer to hash function
 			 * \param name Name of the algorithm
 			 */
 			hmacsha(std::string key, const EVP_MD*(*md)(), const std::string& name)
-				: secret(std::move(key)), md(md), alg_name(name)
-			{}
+				: secret(std::move(key)), md(md), alg_name(name), keyed_ctx(new_ctx(), free_ctx)
+			{
+				if (keyed_ctx && !HMAC_Init_ex(keyed_ctx.get(), secret.data(), secret.size(), md(), nullptr))
+					keyed_ctx.reset();
+			}
 			/**
 			 * Sign jwt data
 			 * \param data The data to sign
 			 * \return HMAC signature for the given data
 			 * \{}//throws signature_generation_exception
 			 */
-			std::string sign(const std::string& data) const {
+			std::string sign(std::string_view data) const {
 				std::string res;
+				sign(data, res);
+				return res;
+			}
+			/**
+			 * Same as sign(), but writes the signature to res, so a caller signing many tokens can reuse its buffer
+			 */
+			void sign(std::string_view data, std::string& res) const {
 				res.resize(EVP_MAX_MD_SIZE);
-				unsigned int len = res.size();
-				if (HMAC(md(), secret.data(), secret.size(), (const unsigned char*)data.data(), data.size(), (unsigned char*)res.data(), &len) == nullptr)
+				unsigned int len = 0;
+				if (!compute(data, (unsigned char*)res.data(), len))
 					{}//throw signature_generation_exception();
 				res.resize(len);
-				return res;
 			}
 			/**
 			 * Check if signature is valid
 			 * \param data The data to check signature against
 			 * \param signature Signature provided by the jwt
+			 * \return true if the signature matches
 			 * \{}//throws signature_verification_exception If the provided signature does not match
 			 */
-			void verify(const std::string& data, const std::string& signature) const {
-				/*try {*/
-					auto res = sign(data);
-					bool matched = true;
-					for (size_t i = 0; i < std::min<size_t>(res.size(), signature.size()); i++)
-						if (res[i] != signature[i])
-							matched = false;
-					if (res.size() != signature.size())
-						matched = false;
-					if (!matched)
-						{}//throw signature_verification_exception();
-				/*}
-				catch (const signature_generation_exception&) {
-					{}//throw signature_verification_exception();
-				}*/
+			bool verify(std::string_view data, std::string_view signature) const {
+				unsigned char res[EVP_MAX_MD_SIZE];
+				unsigned int len = 0;
+				if (!compute(data, res, len) || len != signature.size())
+					return false; //throw signature_verification_exception();
+				// constant time, so the comparison doesn't leak how much of a forged signature is right
+				if (CRYPTO_memcmp(res, signature.data(), len) != 0)
+					return false; //throw signature_verification_exception();
+				return true;
 			}
 			/**
 			 * Returns the algorithm name provided to the constructor
@@ -216,12 +229,44 @@ namespace jwt {
 				return alg_name;
 			}
 		private:
+			/// Writes the HMAC of data to res, which needs room for EVP_MAX_MD_SIZE bytes
+			bool compute(std::string_view data, unsigned char* res, unsigned int& len) const {
+				// every thread reuses its own context, HMAC_CTX_copy only allocates on first use
+				thread_local std::unique_ptr<HMAC_CTX, decltype(&free_ctx)> ctx(new_ctx(), free_ctx);
+				if (keyed_ctx && ctx
+					&& HMAC_CTX_copy(ctx.get(), keyed_ctx.get())
+					&& HMAC_Update(ctx.get(), (const unsigned char*)data.data(), data.size())
+					&& HMAC_Final(ctx.get(), res, &len))
+					return true;
+
+				return HMAC(md(), secret.data(), secret.size(), (const unsigned char*)data.data(), data.size(), res, &len) != nullptr;
+			}
+#ifdef OPENSSL10
+			static HMAC_CTX* new_ctx() {
+				HMAC_CTX* ctx = new HMAC_CTX;
+				HMAC_CTX_init(ctx);
+				return ctx;
+			}
+			static void free_ctx(HMAC_CTX* ctx) {
+				HMAC_CTX_cleanup(ctx);
+				delete ctx;
+			}
+#else
+			static HMAC_CTX* new_ctx() {
+				return HMAC_CTX_new();
+			}
+			static void free_ctx(HMAC_CTX* ctx) {
+				HMAC_CTX_free(ctx);
+			}
+#endif
 			/// HMAC secrect
 			const std::string secret;
 			/// HMAC hash generator
 			const EVP_MD*(*md)();
 			/// Algorithmname
 			const std::string alg_name;
+			/// Context keyed with secret, shared by all copies of this algorithm
+			std::shared_ptr<HMAC_CTX> keyed_ctx;
 		};
 		/**
 		 * Base class for RSA family of algorithms
@@ -246,6 +291,15 @@ namespace jwt {
 				} else{}
 					{}//throw rsa_exception("at least one of public or private key need to be present");
 			}
+			/**
+			 * Construct new rsa algorithm from an already parsed key
+			 * \param key RSA key, private key for signing, public or private key for verification
+			 * \param md Pointer to hash function
+			 * \param name Name of the algorithm
+			 */
+			rsa(std::shared_ptr<EVP_PKEY> key, const EVP_MD*(*md)(), const std::string& name)
+				: pkey(std::move(key)), md(md), alg_name(name)
+			{}
 			/**
 			 * Sign jwt data
 			 * \param data The data to sign
@@ -253,6 +307,14 @@ namespace jwt {
 			 * \{}//throws signature_generation_exception
 			 */
 			std::string sign(const std::string& data) const {
+				std::string res;
+				sign(data, res);
+				return res;
+			}
+			/**
+			 * Same as sign(), but writes the signature to res, so a caller signing many tokens can reuse its buffer
+			 */
+			void sign(std::string_view data, std::string& res) const {
 #ifdef OPENSSL10
 				std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_destroy)> ctx(EVP_MD_CTX_create(), EVP_MD_CTX_destroy);
 #else
@@ -263,7 +325,6 @@ namespace jwt {
 				if (!EVP_SignInit(ctx.get(), md()))
 					{}//throw signature_generation_exception("failed to create signature: SignInit failed");
 
-				std::string res;
 				res.resize(EVP_PKEY_size(pkey.get()));
 				unsigned int len = 0;
 
@@ -273,29 +334,30 @@ namespace jwt {
 					{}//throw signature_generation_exception();
 
 				res.resize(len);
-				return res;
 			}
 			/**
 			 * Check if signature is valid
 			 * \param data The data to check signature against
 			 * \param signature Signature provided by the jwt
+			 * \return true if the signature matches
 			 * \{}//throws signature_verification_exception If the provided signature does not match
 			 */
-			void verify(const std::string& data, const std::string& signature) const {
+			bool verify(std::string_view data, std::string_view signature) const {
 #ifdef OPENSSL10
 				std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_destroy)> ctx(EVP_MD_CTX_create(), EVP_MD_CTX_destroy);
 #else
 				std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> ctx(EVP_MD_CTX_create(), EVP_MD_CTX_free);
 #endif
 				if (!ctx)
-					{}//throw signature_verification_exception("failed to verify signature: could not create context");
+					return false; //throw signature_verification_exception("failed to verify signature: could not create context");
 				if (!EVP_VerifyInit(ctx.get(), md()))
-					{}//throw signature_verification_exception("failed to verify signature: VerifyInit failed");
+					return false; //throw signature_verification_exception("failed to verify signature: VerifyInit failed");
 				if (!EVP_VerifyUpdate(ctx.get(), data.data(), data.size()))
-					{}//throw signature_verification_exception("failed to verify signature: VerifyUpdate failed");
+					return false; //throw signature_verification_exception("failed to verify signature: VerifyUpdate failed");
 				auto res = EVP_VerifyFinal(ctx.get(), (const unsigned char*)signature.data(), signature.size(), pkey.get());
 				if (res != 1)
-					{}//throw signature_verification_exception("evp verify final failed: " + std::to_string(res) + " " + ERR_error_string(ERR_get_error(), NULL));
+					return false; //throw signature_verification_exception("evp verify final failed: " + std::to_string(res) + " " + ERR_error_string(ERR_get_error(), NULL));
+				return true;
 			}
 			/**
 			 * Returns the algorithm name provided to the constructor
@@ -633,6 +695,13 @@ namespace jwt {
 			explicit rs256(const std::string& public_key, const std::string& private_key = "", const std::string& public_key_password = "", const std::string& private_key_password = "")
 				: rsa(public_key, private_key, public_key_password, private_key_password, EVP_sha256, "RS256")
 			{}
+			/**
+			 * Construct new instance of algorithm from an already parsed key
+			 * \param key RSA key, see rsa::rsa
+			 */
+			explicit rs256(std::shared_ptr<EVP_PKEY> key)
+				: rsa(std::move(key), EVP_sha256, "RS256")
+			{}
 		};
 		/**
 		 * RS384 algorithm
@@ -648,6 +717,13 @@ namespace jwt {
 			explicit rs384(const std::string& public_key, const std::string& private_key = "", const std::string& public_key_password = "", const std::string& private_key_password = "")
 				: rsa(public_key, private_key, public_key_password, private_key_password, EVP_sha384, "RS384")
 			{}
+			/**
+			 * Construct new instance of algorithm from an already parsed key
+			 * \param key RSA key, see rsa::rsa
+			 */
+			explicit rs384(std::shared_ptr<EVP_PKEY> key)
+				: rsa(std::move(key), EVP_sha384, "RS384")
+			{}
 		};
 		/**
 		 * RS512 algorithm
@@ -663,6 +739,13 @@ namespace jwt {
 			explicit rs512(const std::string& public_key, const std::string& private_key = "", const std::string& public_key_password = "", const std::string& private_key_password = "")
 				: rsa(public_key, private_key, public_key_password, private_key_password, EVP_sha512, "RS512")
 			{}
+			/**
+			 * Construct new instance of algorithm from an already parsed key
+			 * \param key RSA key, see rsa::rsa
+			 */
+			explicit rs512(std::shared_ptr<EVP_PKEY> key)
+				: rsa(std::move(key), EVP_sha512, "RS512")
+			{}
 		};
 		/**
 		 * ES256 algorithm
@@ -1144,45 +1227,15 @@ namespace jwt {
 			auto payload_end = token.find('.', hdr_end + 1);
 			if (payload_end == std::string::npos)
 				{}//throw std::invalid_argument("invalid token supplied");
-			header = header_base64 = token.substr(0, hdr_end);
-			payload = payload_base64 = token.substr(hdr_end + 1, payload_end - hdr_end - 1);
-			signature = signature_base64 = token.substr(payload_end + 1);
-
-			// Fix padding: JWT requires padding to get removed
-			auto fix_padding = [](std::string& str) {
-				switch (str.size() % 4) {
-				case 1:
-					str += alphabet::base64url::fill();
-#ifdef __has_cpp_attribute
-#if __has_cpp_attribute(fallthrough)
-					[[fallthrough]];
-#endif
-#endif
-				case 2:
-					str += alphabet::base64url::fill();
-#ifdef __has_cpp_attribute
-#if __has_cpp_attribute(fallthrough)
-					[[fallthrough]];
-#endif
-#endif
-				case 3:
-					str += alphabet::base64url::fill();
-#ifdef __has_cpp_attribute
-#if __has_cpp_attribute(fallthrough)
-					[[fallthrough]];
-#endif
-#endif
-				default:
-					break;
-				}
-			};
-			fix_padding(header);
-			fix_padding(payload);
-			fix_padding(signature);
+			header_base64 = token.substr(0, hdr_end);
+			payload_base64 = token.substr(hdr_end + 1, payload_end - hdr_end - 1);
+			signature_base64 = token.substr(payload_end + 1);
 
-			header = base::decode<alphabet::base64url>(header);
-			payload = base::decode<alphabet::base64url>(payload);
-			signature = base::decode<alphabet::base64url>(signature);
+			// JWT requires padding to get removed, base::try_decode accepts unpadded input
+			if (!base::try_decode<alphabet::base64url>(header_base64.data(), header_base64.size(), header)
+				|| !base::try_decode<alphabet::base64url>(payload_base64.data(), payload_base64.size(), payload)
+				|| !base::try_decode<alphabet::base64url>(signature_base64.data(), signature_base64.size(), signature))
+				{}//throw std::runtime_error("Invalid base64");
 
 			auto parse_claims = [](const std::string& str) {
 				std::unordered_map<std::string, claim> res;
@@ -1237,6 +1290,351 @@ namespace jwt {
 
 	};
 
+	/**
+	 * Lightweight alternative to decoded_jwt that doesn't copy the token.
+	 * The base64 parts are views into the caller's buffer, header, payload and signature are decoded into one scratch
+	 * buffer that is reused by the next parse(), so a view that is kept around usually doesn't allocate at all.
+	 * Claims aren't parsed, pass get_header() / get_payload() to the json parser of your choice.
+	 */
+	class decoded_jwt_view {
+		/// Unmodified token, as passed to parse()
+		std::string_view token;
+		/// Unmodified header part in base64
+		std::string_view header_base64;
+		/// Unmodified payload part in base64
+		std::string_view payload_base64;
+		/// Unmodified signature part in base64
+		std::string_view signature_base64;
+		/// Decoded header, payload and signature back to back
+		std::string scratch;
+		/// End of the decoded header and payload inside scratch
+		size_t header_end = 0;
+		size_t payload_end = 0;
+	public:
+		/**
+		 * Split and decode a token
+		 * \param jwt The token, has to outlive every view returned by this object
+		 * \return false if the token doesn't have three parts or isn't valid base64url
+		 */
+		bool parse(std::string_view jwt) {
+			token = header_base64 = payload_base64 = signature_base64 = {};
+			scratch.clear();
+			header_end = payload_end = 0;
+
+			const auto hdr_end = jwt.find('.');
+			if (hdr_end == std::string_view::npos)
+				return false;
+			const auto pl_end = jwt.find('.', hdr_end + 1);
+			if (pl_end == std::string_view::npos || jwt.find('.', pl_end + 1) != std::string_view::npos)
+				return false;
+
+			const std::string_view hdr = jwt.substr(0, hdr_end);
+			const std::string_view pl = jwt.substr(hdr_end + 1, pl_end - hdr_end - 1);
+			const std::string_view sig = jwt.substr(pl_end + 1);
+
+			// the decoded size is at most 3/4 of the encoded one, so reserving up front means a single allocation at most
+			scratch.reserve(jwt.size());
+			if (!base::try_decode_append<alphabet::base64url>(hdr.data(), hdr.size(), scratch))
+				return false;
+			header_end = scratch.size();
+			if (!base::try_decode_append<alphabet::base64url>(pl.data(), pl.size(), scratch))
+				return false;
+			payload_end = scratch.size();
+			if (!base::try_decode_append<alphabet::base64url>(sig.data(), sig.size(), scratch))
+				return false;
+
+			token = jwt;
+			header_base64 = hdr;
+			payload_base64 = pl;
+			signature_base64 = sig;
+			return true;
+		}
+
+		/**
+		 * Get token, as passed to parse()
+		 */
+		std::string_view get_token() const noexcept { return token; }
+		/**
+		 * Get header part as json string
+		 */
+		std::string_view get_header() const noexcept { return std::string_view(scratch).substr(0, header_end); }
+		/**
+		 * Get payload part as json string
+		 */
+		std::string_view get_payload() const noexcept { return std::string_view(scratch).substr(header_end, payload_end - header_end); }
+		/**
+		 * Get raw signature
+		 */
+		std::string_view get_signature() const noexcept { return std::string_view(scratch).substr(payload_end); }
+		/**
+		 * Get header part as base64 string
+		 */
+		std::string_view get_header_base64() const noexcept { return header_base64; }
+		/**
+		 * Get payload part as base64 string
+		 */
+		std::string_view get_payload_base64() const noexcept { return payload_base64; }
+		/**
+		 * Get signature part as base64 string
+		 */
+		std::string_view get_signature_base64() const noexcept { return signature_base64; }
+		/**
+		 * Get the data the signature was computed over, the header and payload in base64 separated by a dot
+		 */
+		std::string_view get_signed_data() const noexcept { return token.substr(0, header_base64.size() + 1 + payload_base64.size()); }
+	};
+
+	/**
+	 * Parsed header or payload of a decoded_jwt_view, with the accessors verification needs.
+	 * Backed by flat_json, or by picojson if JWT_FLAT_JSON is 0. Accessors return false instead of reading a claim of the
+	 * wrong type.
+	 */
+	class claims_document {
+	public:
+		/**
+		 * One claim of the document, only valid as long as the document isn't changed
+		 */
+		class value_view {
+		public:
+			claim::type get_type() const {
+#if JWT_FLAT_JSON
+				switch (c->kind) {
+				case flat_json::type::boolean: return claim::type::boolean;
+				case flat_json::type::int64: return claim::type::int64;
+				case flat_json::type::number: return claim::type::number;
+				case flat_json::type::string: return claim::type::string;
+				case flat_json::type::array: return claim::type::array;
+				case flat_json::type::object: return claim::type::object;
+				default: return claim::type::null;
+				}
+#else
+				if (c->is<picojson::null>()) return claim::type::null;
+				if (c->is<bool>()) return claim::type::boolean;
+				if (c->is<int64_t>()) return claim::type::int64;
+				if (c->is<double>()) return claim::type::number;
+				if (c->is<std::string>()) return claim::type::string;
+				if (c->is<picojson::array>()) return claim::type::array;
+				return claim::type::object;
+#endif
+			}
+			/// Unescaped string, only valid if the type is string
+			std::string_view as_string() const {
+#if JWT_FLAT_JSON
+				return doc->get_text(*c);
+#else
+				return c->get<std::string>();
+#endif
+			}
+			/// Only valid if the type is int64
+			int64_t as_int() const {
+#if JWT_FLAT_JSON
+				return c->int_value;
+#else
+				return c->get<int64_t>();
+#endif
+			}
+			/// Only valid if the type is number
+			double as_number() const {
+#if JWT_FLAT_JSON
+				return c->number_value;
+#else
+				return c->get<double>();
+#endif
+			}
+			/// Only valid if the type is boolean
+			bool as_bool() const {
+#if JWT_FLAT_JSON
+				return c->boolean_value;
+#else
+				return c->get<bool>();
+#endif
+			}
+			/// Call f(const value_view&) for every element, only valid if the type is array
+			template<typename F>
+			void for_each_element(F&& f) const {
+#if JWT_FLAT_JSON
+				doc->for_each_child(*c, [&](const flat_json::node& e) { f(value_view(doc, &e)); });
+#else
+				for (const auto& e : c->get<picojson::array>())
+					f(value_view(&e));
+#endif
+			}
+			/// Number of elements, only valid if the type is array
+			size_t size() const {
+#if JWT_FLAT_JSON
+				return c->size;
+#else
+				return c->get<picojson::array>().size();
+#endif
+			}
+			/// Append the json text of the value to res
+			void serialize(std::string& res) const {
+#if JWT_FLAT_JSON
+				doc->serialize(*c, res);
+#else
+				c->serialize(std::back_inserter(res));
+#endif
+			}
+
+		private:
+			friend class claims_document;
+#if JWT_FLAT_JSON
+			value_view(const flat_json* doc, const flat_json::node* c) : doc(doc), c(c) {}
+
+			const flat_json* doc;
+			const flat_json::node* c;
+#else
+			explicit value_view(const picojson::value* c) : c(c) {}
+
+			const picojson::value* c;
+#endif
+		};
+
+		/**
+		 * \return false if json isn't a valid json object
+		 */
+		bool parse(std::string_view json) {
+#if JWT_FLAT_JSON
+			return doc.parse(json);
+#else
+			picojson::value val;
+			std::string err;
+			picojson::parse(val, json.begin(), json.end(), &err);
+			if (!err.empty() || !val.is<picojson::object>()) {
+				claims.clear();
+				return false;
+			}
+			claims = std::move(val.get<picojson::object>());
+			return true;
+#endif
+		}
+		bool has(std::string_view name) const { return find(name) != nullptr; }
+		/**
+		 * \return false if the claim is missing or not a string
+		 */
+		bool get_string(std::string_view name, std::string_view& res) const {
+			const auto c = find(name);
+#if JWT_FLAT_JSON
+			if (!c || c->kind != flat_json::type::string)
+				return false;
+			res = doc.get_text(*c);
+#else
+			if (!c || !c->is<std::string>())
+				return false;
+			res = c->get<std::string>();
+#endif
+			return true;
+		}
+		/**
+		 * Get a NumericDate claim (exp, nbf, iat), fractional seconds are truncated
+		 * \return false if the claim is missing, not a number, or doesn't fit into int64_t (NaN, 1e300, ...)
+		 */
+		bool get_time(std::string_view name, int64_t& res) const {
+			const auto c = find(name);
+#if JWT_FLAT_JSON
+			if (c && c->kind == flat_json::type::int64) {
+				res = c->int_value;
+				return true;
+			}
+			return c && c->kind == flat_json::type::number && to_time(c->number_value, res);
+#else
+			if (c && c->is<int64_t>()) {
+				res = c->get<int64_t>();
+				return true;
+			}
+			return c && c->is<double>() && to_time(c->get<double>(), res);
+#endif
+		}
+		/**
+		 * \return true if the claim is the string value, or an array containing it (like "aud")
+		 */
+		bool contains(std::string_view name, std::string_view value) const {
+			const auto c = find(name);
+			if (!c)
+				return false;
+			bool res = false;
+#if JWT_FLAT_JSON
+			if (c->kind == flat_json::type::string)
+				return doc.get_text(*c) == value;
+			if (c->kind == flat_json::type::array)
+				doc.for_each_child(*c, [&](const flat_json::node& e) {
+					res |= e.kind == flat_json::type::string && doc.get_text(e) == value;
+				});
+#else
+			if (c->is<std::string>())
+				return c->get<std::string>() == value;
+			if (c->is<picojson::array>())
+				for (const auto& e : c->get<picojson::array>())
+					res |= e.is<std::string>() && e.get<std::string>() == value;
+#endif
+			return res;
+		}
+		/**
+		 * Number of claims
+		 */
+		size_t size() const {
+#if JWT_FLAT_JSON
+			return doc.get_nodes().empty() ? 0 : doc.get_nodes()[0].size;
+#else
+			return claims.size();
+#endif
+		}
+		/**
+		 * Call f(std::string_view name, const value_view& value) for every claim, nothing is serialized
+		 */
+		template<typename F>
+		void for_each_claim(F&& f) const {
+#if JWT_FLAT_JSON
+			doc.for_each_member([&](const flat_json::node& c) { f(doc.get_key(c), value_view(&doc, &c)); });
+#else
+			for (const auto& c : claims)
+				f(std::string_view(c.first), value_view(&c.second));
+#endif
+		}
+		/**
+		 * Call f(std::string_view name, const std::string& json) for every claim, json is the serialized value
+		 */
+		template<typename F>
+		void for_each_json(F&& f) const {
+			std::string json;
+#if JWT_FLAT_JSON
+			doc.for_each_member([&](const flat_json::node& c) {
+				json.clear();
+				doc.serialize(c, json);
+				f(doc.get_key(c), json);
+			});
+#else
+			for (const auto& c : claims) {
+				json.clear();
+				c.second.serialize(std::back_inserter(json));
+				f(std::string_view(c.first), json);
+			}
+#endif
+		}
+
+	private:
+		/// Truncates value to whole seconds, false for NaN and values outside of int64_t, where the cast would be undefined
+		static bool to_time(double value, int64_t& res) {
+			// both bounds are exact powers of two, so the comparisons aren't affected by rounding
+			if (!(value >= -9223372036854775808.0 && value < 9223372036854775808.0))
+				return false;
+			res = static_cast<int64_t>(value);
+			return true;
+		}
+#if JWT_FLAT_JSON
+		const flat_json::node* find(std::string_view name) const { return doc.find(name); }
+
+		flat_json doc;
+#else
+		const picojson::value* find(std::string_view name) const {
+			const auto it = claims.find(std::string(name));
+			return it != claims.end() ? &it->second : nullptr;
+		}
+
+		picojson::object claims;
+#endif
+	};
+
 	/**
 	 * Builder class to build and sign a new token
 	 * Use jwt::create() to get an instance of this class.
@@ -1354,9 +1752,8 @@ namespace jwt {
 			}
 
 			auto encode = [](const std::string& data) {
-				auto base = base::encode<alphabet::base64url>(data);
-				auto pos = base.find(alphabet::base64url::fill());
-				base = base.substr(0, pos);
+				std::string base;
+				base::encode<alphabet::base64url>(data.data(), data.size(), base, false);
 				return base;
 			};
 